@@ -0,0 +1,178 @@
+#include "atem_source.h"
+
+#if TALLY_ATEM
+
+void AtemSource::Begin() {
+  ClearCameras();
+  // Initialize a connection to the switcher
+  _atem_switcher.begin(_server);
+  // set to 0x80 to enable debug
+  _atem_switcher.serialOutput(0);
+  _atem_switcher.connect();
+  _started = true;
+  _resync = true;
+}
+
+void AtemSource::Poll() {
+  if (!_started) {
+    return;
+  }
+  // Check for packets, respond to them etc. Keeping the connection alive!
+  // VERY important that this function is called all the time - otherwise
+  // connection might be lost because packets from the switcher is
+  // overlooked and not responded to.
+  _atem_switcher.runLoop();
+  HandleData();
+}
+
+void AtemSource::Teardown() {
+  // frees the W5100 socket, the switcher drops the session once we stop
+  // answering
+  _atem_switcher.disconnect();
+  _started = false;
+  ClearCameras();
+}
+
+SOURCE_HEALTH AtemSource::Health() {
+  if (!_started) {
+    return SOURCE_DOWN;
+  }
+  return _atem_switcher.hasInitialized() ? SOURCE_UP : SOURCE_CONNECTING;
+}
+
+/**
+ * @brief update camera status from the ATEM tally flags
+ *  Only the sources flagged as changed by the last TlIn packets are visited,
+ *  and nothing at all is done until a tally generation moves. A TlSr change
+ *  re-evaluates just the cameras with a source feed, a PrgI/PrvI change the
+ *  groups with a routed M/E. Once the switcher's initial state is in after
+ *  Begin(), every camera is re-evaluated.
+ */
+void AtemSource::HandleData() {
+  uint8_t generation = _atem_switcher.getTallyByIndexGeneration();
+  uint8_t source_generation = _atem_switcher.getTallyBySourceGeneration();
+  uint8_t me_generation = _atem_switcher.getInputVideoSourceGeneration();
+  bool resync = _resync && _atem_switcher.hasInitialized();
+  if (!resync && generation == _atem_tally_generation &&
+      source_generation == _atem_source_generation &&
+      me_generation == _atem_me_generation) {
+    return;
+  }
+  bool index_changed = generation != _atem_tally_generation;
+  bool source_changed = source_generation != _atem_source_generation;
+  bool me_changed = me_generation != _atem_me_generation;
+
+  for (uint8_t group = 0; group < TALLY_GROUPS; group++) {
+    bool routed = false;
+    for (uint8_t me = 0; me < ATEM_MES; me++) {
+      routed |= _me_group[me] == group;
+    }
+    for (uint8_t camera = 0; camera < MAX_TALLY; camera++) {
+      bool fed = (_feed_cameras[camera / TALLY_MASK_BITS] >>
+                  (camera % TALLY_MASK_BITS)) & 1;
+      if (resync ||
+          (group == 0 && index_changed &&
+           _atem_switcher.getTallyByIndexChanged(camera)) ||
+          (source_changed && fed) || (me_changed && routed)) {
+        UpdateCamera(group, camera);
+      }
+    }
+  }
+  _atem_switcher.clearTallyByIndexChanged();
+  _resync = _resync && !resync;
+  _atem_tally_generation = generation;
+  _atem_source_generation = source_generation;
+  _atem_me_generation = me_generation;
+}
+
+/**
+ * @brief camera tally in one group: for group 0 its own input (TlIn) OR'ed
+ *  with every source that feeds it (TlSr), then OR'ed with the program and
+ *  preview bus of each M/E routed to the group
+ *
+ * @param group tally group
+ * @param camera 0-based camera index
+ */
+void AtemSource::UpdateCamera(uint8_t group, uint8_t camera) {
+  uint8_t flags = 0;
+  if (group == 0) {
+    flags = _atem_switcher.getTallyByIndexTallyFlags(camera);
+    for (uint8_t i = 0; i < _feed_count; i++) {
+      if (_feed_camera[i] == camera) {
+        flags |= _atem_switcher.getTallyBySourceTallyFlags(_feed_source[i]);
+      }
+    }
+  }
+  for (uint8_t me = 0; me < ATEM_MES; me++) {
+    if (_me_group[me] != group) {
+      continue;
+    }
+    if (IsFedBy(camera, _atem_switcher.getProgramInputVideoSource(me))) {
+      flags |= 0x01;
+    }
+    if (IsFedBy(camera, _atem_switcher.getPreviewInputVideoSource(me))) {
+      flags |= 0x02;
+    }
+  }
+  SetCamera(group, camera, flags & 0x01, flags & 0x02);
+}
+
+/**
+ * @brief true if the ATEM video source is the camera's input (camera n on
+ *  input n) or a source it feeds, see AddSourceFeed
+ */
+bool AtemSource::IsFedBy(uint8_t camera, uint16_t video_source) {
+  if (video_source == camera + 1) {
+    return true;
+  }
+  for (uint8_t i = 0; i < _feed_count; i++) {
+    if (_feed_camera[i] == camera && _feed_source[i] == video_source) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief light a camera whenever an ATEM source it feeds is on air, e.g.
+ *  AddSourceFeed(6000, 2) for camera 2 used as a SuperSource box. Tally by
+ *  source (TlSr) covers every source in ATEMbase::getVideoSrcIndex(): inputs,
+ *  media players, SuperSource, color generators and M/E outputs.
+ *
+ * @param video_source ATEM video source id
+ * @param tally_number 1-based camera number
+ * @return false if the feed table (MAX_SOURCE_FEEDS) is full or the camera
+ *  is out of range
+ */
+bool AtemSource::AddSourceFeed(uint16_t video_source, uint8_t tally_number) {
+  if (_feed_count >= MAX_SOURCE_FEEDS || tally_number < 1 ||
+      tally_number > MAX_TALLY) {
+    return false;
+  }
+  uint8_t camera = tally_number - 1;
+  _feed_source[_feed_count] = video_source;
+  _feed_camera[_feed_count] = camera;
+  _feed_count++;
+  _feed_cameras[camera / TALLY_MASK_BITS] |= (tally_mask_t)1
+                                              << (camera % TALLY_MASK_BITS);
+  return true;
+}
+
+/**
+ * @brief send the program/preview bus of an ATEM M/E to a tally group, e.g.
+ *  RouteMe(2, 1) gives M/E 2 (feeding a separate record) its own RF group,
+ *  RouteMe(2, 0) merges it into the main tally. Call before connecting.
+ *
+ * @param me_number 1-based M/E number
+ * @param group tally group, < TALLY_GROUPS
+ * @return false if the M/E or the group is out of range
+ */
+bool AtemSource::RouteMe(uint8_t me_number, uint8_t group) {
+  if (me_number < 1 || me_number > ATEM_MES || group >= TALLY_GROUPS) {
+    return false;
+  }
+  _me_group[me_number - 1] = group;
+  return true;
+}
+
+#endif  // TALLY_ATEM
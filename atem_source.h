@@ -0,0 +1,74 @@
+#ifndef ATEM_SOURCE_h
+#define ATEM_SOURCE_h
+
+#include "tally_source.h"
+
+#if TALLY_ATEM
+
+#include <ATEMbase.h>
+#if TALLY_ATEM_STD
+#include <ATEMstd.h>
+typedef ATEMstd AtemClient;
+#else
+#include <ATEMtally.h>
+typedef ATEMtally AtemClient;
+#endif
+
+#if MAX_TALLY > ATEM_maxTallySources
+#error "MAX_TALLY exceeds ATEM_maxTallySources, the ATEM tally would be cut off"
+#endif
+
+// entries in the ATEM source feed table, see AtemSource::AddSourceFeed
+#ifndef MAX_SOURCE_FEEDS
+#define MAX_SOURCE_FEEDS 4
+#endif
+
+// M/Es tracked by ATEMstd and ATEMtally (atemProgramInputVideoSource[2])
+#define ATEM_MES 2
+#define ME_NOT_ROUTED 0xFF
+
+/**
+ * @brief ATEM switchers over UDP 9910: tally by index (TlIn) on group 0,
+ *  optionally tally by source (TlSr) fanned out to cameras and M/E buses
+ *  routed to tally groups
+ */
+class AtemSource : public TallySource {
+ private:
+  AtemClient _atem_switcher;
+  IPAddress _server;
+  bool _started = false;
+  // the client flags only what differs from its flags before a reconnect, all
+  // cameras are read once it has initialized
+  bool _resync = false;
+
+  uint8_t _atem_tally_generation = 0;
+  uint8_t _atem_source_generation = 0;
+  uint8_t _atem_me_generation = 0;
+  // tally group fed by the program/preview bus of each M/E
+  uint8_t _me_group[ATEM_MES] = {ME_NOT_ROUTED, ME_NOT_ROUTED};
+  // ATEM sources (e.g. SuperSource) whose tally is fanned out to a camera
+  uint16_t _feed_source[MAX_SOURCE_FEEDS];
+  uint8_t _feed_camera[MAX_SOURCE_FEEDS];
+  uint8_t _feed_count = 0;
+  tally_mask_t _feed_cameras[TALLY_MASK_WORDS] = {0};
+
+  void HandleData();
+  void UpdateCamera(uint8_t group, uint8_t camera);
+  bool IsFedBy(uint8_t camera, uint16_t video_source);
+
+ public:
+  explicit AtemSource(IPAddress server) : _server(server) {}
+
+  bool AddSourceFeed(uint16_t video_source, uint8_t tally_number);
+  bool RouteMe(uint8_t me_number, uint8_t group);
+
+  void Begin() override;
+  void Poll() override;
+  void Teardown() override;
+  SOURCE_HEALTH Health() override;
+  const char* Name() override { return "ATEM"; }
+};
+
+#endif  // TALLY_ATEM
+
+#endif
@@ -0,0 +1,147 @@
+/**
+ * Synthetic ATEM initial state dump for the host benchmarks.
+ *
+ * The command mix and body sizes follow what a 1 M/E switcher sends right
+ * after the handshake (~260 commands over a handful of packets), so the
+ * interesting commands such as TlIn sit behind many that nobody reads.
+ */
+#ifndef BENCH_ATEM_DUMP_h
+#define BENCH_ATEM_DUMP_h
+
+#include <arpa/inet.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "ATEMstd.h"
+
+namespace bench {
+
+struct AtemCommand {
+  char name[5];
+  uint16_t body_length;
+  uint8_t count;
+};
+
+static const AtemCommand kInitialDump[] = {
+    {"_ver", 4, 1},   {"_pin", 44, 1},  {"_top", 12, 1},  {"_MeC", 4, 1},
+    {"_mpl", 4, 1},   {"_MvC", 4, 1},   {"_SSC", 4, 1},   {"_TlC", 8, 1},
+    {"_AMC", 4, 1},   {"_VMC", 4, 1},   {"_MAC", 4, 1},   {"Powr", 4, 1},
+    {"VidM", 4, 1},   {"InPr", 36, 26}, {"MvPr", 4, 1},   {"MvIn", 4, 20},
+    {"MvVM", 4, 10},  {"VuMC", 4, 10},  {"SaMw", 4, 10},  {"PrgI", 4, 1},
+    {"PrvI", 4, 1},   {"TrSS", 4, 1},   {"TrPr", 4, 1},   {"TrPs", 8, 1},
+    {"TMxP", 4, 1},   {"TDpP", 4, 1},   {"TWpP", 20, 1},  {"TDvP", 20, 1},
+    {"TStP", 16, 1},  {"KeOn", 4, 1},   {"KeBP", 20, 1},  {"KeLm", 12, 1},
+    {"KeCk", 12, 1},  {"KePt", 24, 1},  {"KeDV", 64, 1},  {"KeFS", 4, 1},
+    {"KKFP", 56, 2},  {"DskB", 8, 2},   {"DskP", 20, 2},  {"DskS", 8, 2},
+    {"FtbP", 4, 1},   {"FtbS", 4, 1},   {"ColV", 8, 2},   {"AuxS", 4, 1},
+    {"CCdo", 8, 30},  {"CCdP", 24, 30}, {"RCPS", 60, 2},  {"MPCE", 4, 2},
+    {"MPSp", 4, 1},   {"MPCS", 48, 2},  {"MPAS", 48, 2},  {"MPfe", 60, 20},
+    {"MRPr", 4, 1},   {"MPrp", 48, 10}, {"MRcS", 4, 1},   {"SSrc", 36, 1},
+    {"SSBP", 20, 4},  {"AMIP", 20, 24}, {"AMMO", 8, 1},   {"AMmO", 4, 1},
+    {"AMTl", 4, 1},   {"TlIn", 24, 1},  {"TlSr", 142, 1}, {"Time", 8, 1},
+    {"InCm", 4, 1},
+};
+
+typedef std::vector<uint8_t> Packet;
+
+/**
+ * @brief builds the dump as ATEM packets of at most max_length bytes
+ *
+ * TlIn carries `tally_sources` flags cycling off/program/preview, TlSr
+ * black, inputs and every other source of ATEMbase::getVideoSrcIndex() as
+ * far as its body holds, flags cycling the same way; every other body is
+ * zero.
+ */
+inline std::vector<Packet> BuildInitialDump(uint16_t tally_sources = 20,
+                                            uint16_t max_length = 1300) {
+  std::vector<Packet> packets;
+  Packet payload;
+  auto flush = [&]() {
+    if (payload.empty()) return;
+    uint16_t length = payload.size() + 12;
+    Packet packet(12, 0);
+    packet[0] = (length >> 8) & 0x07;
+    packet[1] = length & 0xFF;
+    packet.insert(packet.end(), payload.begin(), payload.end());
+    packets.push_back(packet);
+    payload.clear();
+  };
+
+  for (const AtemCommand& cmd : kInitialDump) {
+    for (uint8_t i = 0; i < cmd.count; i++) {
+      uint16_t body_length = cmd.body_length;
+      if (!strcmp(cmd.name, "TlIn")) {
+        body_length = (2 + tally_sources + 3) & ~3;
+      }
+      uint16_t length = 8 + body_length;
+      if (payload.size() + length > max_length) flush();
+
+      uint8_t header[8] = {(uint8_t)(length >> 8), (uint8_t)length, 0, 0,
+                           (uint8_t)cmd.name[0], (uint8_t)cmd.name[1],
+                           (uint8_t)cmd.name[2], (uint8_t)cmd.name[3]};
+      payload.insert(payload.end(), header, header + 8);
+      Packet body(body_length, 0);
+      if (!strcmp(cmd.name, "TlIn")) {
+        body[0] = tally_sources >> 8;
+        body[1] = tally_sources & 0xFF;
+        for (uint16_t s = 0; s < tally_sources; s++) body[2 + s] = s % 3;
+      } else if (!strcmp(cmd.name, "TlSr")) {
+        static const uint16_t kOther[] = {
+            1000, 2001, 2002, 3010, 3011, 3020, 3021, 4010, 4020,
+            4030, 4040, 5010, 5020, 6000, 7001, 7002, 8001, 8002,
+            8003, 8004, 8005, 8006, 10010, 10011, 10020, 10021};
+        uint16_t count = (body_length - 2) / 3;
+        uint16_t inputs = count - sizeof(kOther) / sizeof(kOther[0]);
+        body[0] = count >> 8;
+        body[1] = count & 0xFF;
+        for (uint16_t s = 0; s < count; s++) {
+          uint16_t source = s < inputs ? s : kOther[s - inputs];
+          body[2 + s * 3] = source >> 8;
+          body[3 + s * 3] = source & 0xFF;
+          body[4 + s * 3] = s % 3;
+        }
+      }
+      payload.insert(payload.end(), body.begin(), body.end());
+    }
+  }
+  flush();
+  return packets;
+}
+
+inline uint16_t CommandCount() {
+  uint16_t count = 0;
+  for (const AtemCommand& cmd : kInitialDump) count += cmd.count;
+  return count;
+}
+
+/**
+ * @brief feeds packets to an ATEM client through a loopback UDP socket
+ */
+class UdpFeeder {
+ private:
+  int _fd;
+  struct sockaddr_in _to;
+
+ public:
+  explicit UdpFeeder(uint16_t port) {
+    _fd = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(&_to, 0, sizeof(_to));
+    _to.sin_family = AF_INET;
+    _to.sin_port = htons(port);
+    _to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  }
+  ~UdpFeeder() { close(_fd); }
+
+  void Send(const Packet& packet) {
+    sendto(_fd, packet.data(), packet.size(), 0, (struct sockaddr*)&_to,
+           sizeof(_to));
+  }
+};
+
+}  // namespace bench
+
+#endif
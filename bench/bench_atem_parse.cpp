@@ -0,0 +1,84 @@
+/**
+ * Benchmark: cost of _parsePacket() per command segment on the initial state
+ * dump, i.e. command dispatch plus the reads it triggers, and the W5100
+ * receive traffic (hal::Spi()) the dump causes, for ATEMstd and the
+ * tally-only ATEMtally.
+ *
+ * usage: bench_atem_parse [dumps] [TlIn sources]
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "ATEMtally.h"
+#include "atem_dump.h"
+#include "hal.h"
+
+namespace {
+
+const uint16_t kPort = 50999;
+
+uint64_t NowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+template <class Client>
+class BenchClient : public Client {
+ public:
+  void Listen(uint16_t port) {
+    this->begin(IPAddress(127, 0, 0, 1));
+    this->_Udp.begin(port);
+  }
+
+  // parses one pending packet, returns nanoseconds spent in _parsePacket()
+  uint64_t ParseOne() {
+    int size = this->_Udp.parsePacket();
+    if (size <= 12) return 0;
+    this->_Udp.read(this->_packetBuffer, 12);
+    uint64_t start = NowNs();
+    this->_parsePacket(size);
+    return NowNs() - start;
+  }
+};
+
+template <class Client>
+void Run(const char* name, unsigned long dumps,
+         const std::vector<bench::Packet>& packets) {
+  static BenchClient<Client> client;
+  client.Listen(kPort);
+  bench::UdpFeeder feeder(kPort);
+
+  uint64_t total = 0;
+  hal::Spi() = hal::SpiCounters();
+  for (unsigned long i = 0; i < dumps; i++) {
+    for (const bench::Packet& packet : packets) {
+      feeder.Send(packet);
+      total += client.ParseOne();
+    }
+  }
+
+  printf("%s (%zu bytes, %zu of them ATEMbase)\n", name, sizeof(Client),
+         sizeof(ATEMbase));
+  printf("  _parsePacket: %.1f ns per command, %.2f us per dump (%lu dumps)\n",
+         (double)total / dumps / bench::CommandCount(),
+         (double)total / dumps / 1000.0, dumps);
+  printf("  W5100 receive: %lu payload bytes in %lu read bursts per dump\n",
+         (unsigned long)(hal::Spi().bytes / dumps),
+         (unsigned long)(hal::Spi().bursts / dumps));
+  client.disconnect();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  unsigned long dumps = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 2000;
+  uint16_t tally_sources = (argc > 2) ? strtoul(argv[2], nullptr, 10) : 20;
+  std::vector<bench::Packet> packets = bench::BuildInitialDump(tally_sources);
+
+  printf("initial dump: %u commands in %zu packets, %u TlIn sources\n",
+         bench::CommandCount(), packets.size(), tally_sources);
+  Run<ATEMstd>("ATEMstd", dumps, packets);
+  Run<ATEMtally>("ATEMtally", dumps, packets);
+  return 0;
+}
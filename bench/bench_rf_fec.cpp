@@ -0,0 +1,161 @@
+/**
+ * Benchmark: cost and benefit of the Hamming FEC on RF tally frames.
+ *
+ * A stream of 8 camera keyframes and deltas goes through a binary symmetric
+ * channel (every bit flipped with probability BER) once as plain frames and
+ * once FEC coded, into a TallyFrameDecoder and a TallyFecDecoder. For each
+ * BER it prints the frames delivered intact, the frames lost and the frames
+ * delivered wrong (corrupted but passing the CRC), and the codewords the
+ * FEC corrected; then the host time to encode and decode one frame.
+ *
+ * usage: bench_rf_fec [frames]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <vector>
+
+#include "TallyFec.h"
+#include "TallyFrame.h"
+
+namespace {
+
+uint64_t NowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+struct Frame {
+  uint8_t bytes[TALLY_FRAME_MAX_LENGTH];
+  uint8_t length;
+};
+
+// cuts between 8 cameras, the way RfLink sends them
+std::vector<Frame> BuildFrames(unsigned long count) {
+  std::vector<Frame> frames(count);
+  uint8_t states[2] = {0};
+  uint8_t previous[2] = {0};
+  for (unsigned long i = 0; i < count; i++) {
+    memcpy(previous, states, sizeof(states));
+    TallyFrameSetState(states, rand() % 8, rand() % 3);
+    Frame& frame = frames[i];
+    frame.length = 0;
+    if (i % 4) {
+      frame.length = TallyFrameEncodeDelta(frame.bytes, 0, i, states,
+                                           previous, 8);
+    }
+    if (!frame.length) {
+      frame.length = TallyFrameEncodeKey(frame.bytes, 0, i, states, 8);
+    }
+  }
+  return frames;
+}
+
+uint8_t Channel(uint8_t byte, double ber) {
+  for (uint8_t bit = 0; bit < 8; bit++) {
+    if (rand() < ber * (RAND_MAX + 1.0)) {
+      byte ^= 1 << bit;
+    }
+  }
+  return byte;
+}
+
+template <class Decoder>
+void Check(const Decoder& decoder, const std::vector<Frame>& frames,
+           unsigned long sent, unsigned long* intact, unsigned long* wrong) {
+  // the sequence number tells which frame it claims to be
+  for (unsigned long i = sent + 1; i-- > 0 && sent - i < 256;) {
+    if ((uint8_t)i != decoder.Sequence()) {
+      continue;
+    }
+    const Frame& frame = frames[i];
+    if (decoder.Length() == frame.length &&
+        !memcmp(decoder.Frame(), frame.bytes, frame.length)) {
+      (*intact)++;
+      return;
+    }
+    break;
+  }
+  (*wrong)++;
+}
+
+void Run(const std::vector<Frame>& frames, double ber) {
+  TallyFrameDecoder plain;
+  TallyFecDecoder fec;
+  unsigned long plain_intact = 0, plain_wrong = 0;
+  unsigned long fec_intact = 0, fec_wrong = 0;
+  unsigned long corrected = 0;
+  for (unsigned long i = 0; i < frames.size(); i++) {
+    const Frame& frame = frames[i];
+    for (uint8_t b = 0; b < frame.length; b++) {
+      if (plain.Push(Channel(frame.bytes[b], ber))) {
+        Check(plain, frames, i, &plain_intact, &plain_wrong);
+      }
+      uint8_t pair[2];
+      TallyFecEncode(frame.bytes[b], pair);
+      for (uint8_t c = 0; c < 2; c++) {
+        uint8_t heard = Channel(pair[c], ber);
+        uint8_t sent = c ? frame.bytes[b] >> 4 : frame.bytes[b] & 0x0F;
+        if (heard != pair[c] && TallyFecDecodeNibble(heard) == sent) {
+          corrected++;
+        }
+        if (fec.Push(heard)) {
+          Check(fec, frames, i, &fec_intact, &fec_wrong);
+        }
+      }
+    }
+  }
+  double n = frames.size();
+  printf("%8.4f  %6.2f%%  %6.2f%%  %5lu  %6.2f%%  %6.2f%%  %5lu  %9lu\n", ber,
+         100 * plain_intact / n, 100 - 100 * plain_intact / n, plain_wrong,
+         100 * fec_intact / n, 100 - 100 * fec_intact / n, fec_wrong,
+         corrected);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  unsigned long count = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 200000;
+  srand(1);
+  std::vector<Frame> frames = BuildFrames(count);
+  unsigned long bytes = 0;
+  for (const Frame& frame : frames) {
+    bytes += frame.length;
+  }
+  printf("%lu frames of 8 cameras, %.2f bytes plain, %.2f with FEC\n",
+         count, (double)bytes / count, 2.0 * bytes / count);
+  printf("                 plain                      FEC\n");
+  printf("     BER   intact    lost  wrong"
+         "   intact    lost  wrong  corrected\n");
+  static const double kBer[] = {0, 0.0001, 0.001, 0.003, 0.01, 0.02, 0.05};
+  for (double ber : kBer) {
+    Run(frames, ber);
+  }
+
+  // cost per frame, no channel
+  TallyFrameDecoder plain;
+  TallyFecDecoder fec;
+  volatile unsigned long decoded = 0;
+  uint64_t start = NowNs();
+  for (const Frame& frame : frames) {
+    for (uint8_t b = 0; b < frame.length; b++) {
+      decoded += plain.Push(frame.bytes[b]);
+    }
+  }
+  uint64_t plain_ns = NowNs() - start;
+  start = NowNs();
+  for (const Frame& frame : frames) {
+    for (uint8_t b = 0; b < frame.length; b++) {
+      uint8_t pair[2];
+      TallyFecEncode(frame.bytes[b], pair);
+      decoded += fec.Push(pair[0]);
+      decoded += fec.Push(pair[1]);
+    }
+  }
+  uint64_t fec_ns = NowNs() - start;
+  printf("per frame: plain decode %.1f ns, FEC encode + decode %.1f ns\n",
+         (double)plain_ns / count, (double)fec_ns / count);
+  return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * Benchmark: vMix TCP API lines split and parsed per second by
+ * VmixSource::Receive, the path VmixSource::Poll feeds from the W5100, and
+ * the heap allocations it makes on the way (there should be none).
+ *
+ * Two streams are fed in chunks of 1 to 32 bytes, like the W5100 hands them
+ * out, so lines straddle chunks: SUBSCRIBE TALLY traffic (TALLY lines with
+ * one digit per input, for more inputs than cameras, mixed with other
+ * responses) and SUBSCRIBE ACTS traffic (one activator event per line).
+ *
+ * usage: bench_vmix_lines [lines] [vMix inputs]
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include <new>
+#include <string>
+
+#include "vmix_source.h"
+
+static unsigned long heap_allocations = 0;
+
+// malloc/realloc/calloc are wrapped at link time (see CMakeLists.txt),
+// operator new is replaced here
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void* __real_calloc(size_t count, size_t size);
+
+void* __wrap_malloc(size_t size) {
+  heap_allocations++;
+  return __real_malloc(size);
+}
+void* __wrap_realloc(void* ptr, size_t size) {
+  heap_allocations++;
+  return __real_realloc(ptr, size);
+}
+void* __wrap_calloc(size_t count, size_t size) {
+  heap_allocations++;
+  return __real_calloc(count, size);
+}
+}
+
+void* operator new(size_t size) {
+  heap_allocations++;
+  void* ptr = __real_malloc(size ? size : 1);
+  if (!ptr) throw std::bad_alloc();
+  return ptr;
+}
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+namespace {
+
+uint64_t NowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+std::string BuildTallyStream(unsigned long lines, uint16_t inputs) {
+  static const char* const kOther[] = {
+      "SUBSCRIBE OK TALLY\r\n",
+      "ACTS OK Input 3 1\r\n",
+      "ACTS OK InputPreview 4 1\r\n",
+  };
+  std::string stream;
+  for (unsigned long i = 0; i < lines; i++) {
+    if (i % 4 == 3) {
+      stream += kOther[i / 4 % 3];
+      continue;
+    }
+    stream += "TALLY OK ";
+    for (uint16_t input = 0; input < inputs; input++) {
+      stream += (char)('0' + (input + i) % 3);
+    }
+    stream += "\r\n";
+  }
+  return stream;
+}
+
+std::string BuildActsStream(unsigned long lines, uint16_t inputs) {
+  static const char* const kActivator[] = {"Input", "InputPreview", "Overlay1",
+                                           "InputPlaying"};
+  std::string stream;
+  char line[48];
+  for (unsigned long i = 0; i < lines; i++) {
+    snprintf(line, sizeof(line), "ACTS OK %s %lu %lu\r\n", kActivator[i % 4],
+             i / 4 % inputs + 1, i / 8 % 2);
+    stream += line;
+  }
+  return stream;
+}
+
+void Run(const char* name, const std::string& stream) {
+  static VmixSource source(IPAddress(127, 0, 0, 1));
+  source.Begin();
+  unsigned long parsed = 0;
+  for (char c : stream) {
+    parsed += c == '\n';
+  }
+
+  unsigned long allocations = heap_allocations;
+  uint64_t start = NowNs();
+  size_t offset = 0;
+  for (uint8_t chunk = 1; offset < stream.size(); chunk = chunk % 32 + 1) {
+    uint8_t length =
+        offset + chunk < stream.size() ? chunk : stream.size() - offset;
+    source.Receive((const uint8_t*)stream.data() + offset, length);
+    offset += length;
+  }
+  uint64_t elapsed = NowNs() - start;
+  allocations = heap_allocations - allocations;
+
+  printf("%s: %lu lines, %zu bytes\n", name, parsed, stream.size());
+  printf("  %.1f ns per line, %.0f lines/s, %lu heap allocations\n",
+         (double)elapsed / parsed, parsed * 1e9 / elapsed, allocations);
+  // keep the result alive
+  if (source.Program(0)[0] & source.Preview(0)[0] & 0x80) printf("\n");
+  source.Teardown();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  unsigned long lines = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1000000;
+  uint16_t inputs = (argc > 2) ? strtoul(argv[2], nullptr, 10) : 16;
+  printf("vMix, %u inputs\n", inputs);
+  Run("SUBSCRIBE TALLY", BuildTallyStream(lines, inputs));
+  Run("SUBSCRIBE ACTS", BuildActsStream(lines, inputs));
+  return 0;
+}
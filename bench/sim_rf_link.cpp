@@ -0,0 +1,264 @@
+/**
+ * Simulation: one RfLink transmitter (built with RF_ACKS) and several
+ * TallyReceivers sharing a half-duplex 9600 baud channel, on a manual clock.
+ *
+ * The channel carries one byte per millisecond. A byte sent by one node
+ * reaches every other node, corrupted with that receiver's byte error rate
+ * (receiver n has n / (receivers - 1) of the maximum, the transmitter hears
+ * acks as well as the receiver sent them). Bytes sent by two nodes in the
+ * same millisecond collide and everyone gets garbage. A node does not hear
+ * the channel while it is sending.
+ *
+ * The switcher alternates cuts (program and preview swap) with picking the
+ * next preview, every 2 s and, for 3 s of each minute, every 50 to 70 ms
+ * (--burst sets the middle; not a fixed period, that would line up with
+ * one ack slot; --burst 30 is a sequence of cuts faster than the hold
+ * time). The simulation prints how long lights took to turn red and
+ * green after the switcher, how often they changed, the airtime of frames
+ * and acks, and per receiver how long its light was wrong and the losses
+ * the transmitter learned from its acks against the real ones.
+ *
+ * usage: sim_rf_link [--receivers N] [--seconds N] [--ber X] [--no-acks]
+ *                    [--budget BYTES_PER_S] [--hold MS] [--burst MS]
+ *                    [--no-program-first]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "TallyReceiver.h"
+#include "hal.h"
+#include "rf_link.h"
+
+namespace {
+
+// one radio: what the node wrote waits for the channel, what the channel
+// delivered waits for the node to read it
+class SimPort : public Stream {
+ public:
+  std::deque<uint8_t> tx;
+  std::deque<uint8_t> rx;
+
+  int available() override { return rx.size(); }
+  int read() override {
+    if (rx.empty()) return -1;
+    uint8_t c = rx.front();
+    rx.pop_front();
+    return c;
+  }
+  int peek() override { return rx.empty() ? -1 : rx.front(); }
+  size_t write(uint8_t c) override {
+    tx.push_back(c);
+    return 1;
+  }
+  size_t write(const uint8_t* buffer, size_t size) override {
+    tx.insert(tx.end(), buffer, buffer + size);
+    return size;
+  }
+};
+
+double Random() { return rand() / (RAND_MAX + 1.0); }
+
+void PrintLatency(const char* name, std::vector<long>& samples) {
+  if (samples.empty()) return;
+  std::sort(samples.begin(), samples.end());
+  printf("%s: %zu, p50 %ld ms, p90 %ld ms, p99 %ld ms\n", name,
+         samples.size(), samples[samples.size() / 2],
+         samples[samples.size() * 9 / 10], samples[samples.size() * 99 / 100]);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int receivers = 8;
+  int seconds = 300;
+  double ber = 0.02;
+  bool acks = true;
+  bool program_first = true;
+  int budget = RF_AIRTIME_BUDGET;
+  int hold = RF_HOLD_MS;
+  int burst = 60;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--no-acks")) {
+      acks = false;
+    } else if (!strcmp(argv[i], "--no-program-first")) {
+      program_first = false;
+    } else if (i + 1 < argc && !strcmp(argv[i], "--receivers")) {
+      receivers = atoi(argv[++i]);
+    } else if (i + 1 < argc && !strcmp(argv[i], "--seconds")) {
+      seconds = atoi(argv[++i]);
+    } else if (i + 1 < argc && !strcmp(argv[i], "--budget")) {
+      budget = atoi(argv[++i]);
+    } else if (i + 1 < argc && !strcmp(argv[i], "--hold")) {
+      hold = atoi(argv[++i]);
+    } else if (i + 1 < argc && !strcmp(argv[i], "--burst")) {
+      burst = atoi(argv[++i]);
+    } else if (i + 1 < argc && !strcmp(argv[i], "--ber")) {
+      ber = atof(argv[++i]);
+    } else {
+      fprintf(stderr, "unknown option %s\n", argv[i]);
+      return 1;
+    }
+  }
+  if (burst < 10) {
+    fprintf(stderr, "bursts of cuts 10 ms apart or more\n");
+    return 1;
+  }
+  if (receivers < 1 || receivers > RF_RECEIVERS || receivers > MAX_TALLY) {
+    fprintf(stderr, "1 to %d receivers\n",
+            RF_RECEIVERS < MAX_TALLY ? RF_RECEIVERS : MAX_TALLY);
+    return 1;
+  }
+
+  hal::ManualClock clock;
+  hal::SetClock(&clock);
+  srand(1);
+
+  // node 0 is the transmitter
+  std::vector<SimPort> ports(receivers + 1);
+  RfLink link(&ports[0]);
+  link.SetProgramFirst(program_first);
+  link.SetAirtimeBudget(budget);
+  link.SetHoldTime(hold);
+  std::vector<TallyReceiver*> lights;
+  std::vector<double> error_rate;
+  for (int id = 0; id < receivers; id++) {
+    lights.push_back(new TallyReceiver(&ports[id + 1], id, 0));
+    lights.back()->UseAcks(acks);
+    error_rate.push_back(receivers > 1 ? ber * id / (receivers - 1) : ber);
+  }
+
+  uint8_t status[MAX_TALLY];
+  memset(status, STATUS_OFF, sizeof(status));
+  std::vector<long> wrong_ms(receivers, 0);
+  // when the switcher last turned the camera red/green, -1 once it shows
+  std::vector<long> red_at(receivers, -1);
+  std::vector<long> green_at(receivers, -1);
+  std::vector<uint8_t> last_shown(receivers, TALLY_FRAME_OFF);
+  unsigned long switcher_changes = 0;
+  unsigned long light_changes = 0;
+  std::vector<long> to_red;
+  std::vector<long> to_green;
+  std::vector<unsigned long> corrupted(receivers, 0);
+  unsigned long frame_bytes = 0;
+  unsigned long ack_bytes = 0;
+  unsigned long collisions = 0;
+
+  uint8_t program = 0;
+  uint8_t preview = receivers > 1 ? 1 : 0;
+  bool cut = false;
+  long cut_at = 0;
+  for (long t = 0; t < seconds * 1000L; t++) {
+    if (t >= cut_at) {
+      if (t % 60000 < 3000) {
+        cut_at = t + burst - burst / 6 + rand() % (burst / 3 + 1);
+      } else {
+        cut_at = (t / 2000 + 1) * 2000;
+      }
+      if (cut) {
+        std::swap(program, preview);
+      } else if (receivers > 1) {
+        preview = (program + 1 + rand() % (receivers - 1)) % receivers;
+      }
+      cut = !cut;
+      uint8_t previous[MAX_TALLY];
+      memcpy(previous, status, sizeof(status));
+      memset(status, STATUS_OFF, sizeof(status));
+      status[preview] = STATUS_PREVIEW;
+      status[program] = STATUS_PROGRAM;
+      link.Update(0, status, MAX_TALLY);
+      for (int id = 0; id < receivers; id++) {
+        if (status[id] == previous[id]) continue;
+        switcher_changes++;
+        red_at[id] = status[id] == STATUS_PROGRAM ? t : -1;
+        green_at[id] = status[id] == STATUS_PREVIEW ? t : -1;
+      }
+    }
+
+    // the channel, one byte time
+    int senders = 0;
+    int sender = 0;
+    for (size_t node = 0; node < ports.size(); node++) {
+      if (!ports[node].tx.empty()) {
+        senders++;
+        sender = node;
+      }
+    }
+    if (senders) {
+      uint8_t byte = ports[sender].tx.front();
+      for (size_t node = 0; node < ports.size(); node++) {
+        bool sending = !ports[node].tx.empty();
+        if (sending) {
+          continue;
+        }
+        uint8_t heard = byte;
+        if (senders > 1) {
+          heard = rand();
+        } else if (node && Random() < error_rate[node - 1]) {
+          heard ^= 1 << (rand() % 8);
+          corrupted[node - 1]++;
+        }
+        ports[node].rx.push_back(heard);
+      }
+      if (senders > 1) {
+        collisions++;
+      }
+      for (size_t node = 0; node < ports.size(); node++) {
+        if (!ports[node].tx.empty()) {
+          (node ? ack_bytes : frame_bytes)++;
+          ports[node].tx.pop_front();
+        }
+      }
+    }
+
+    link.Poll();
+    for (int id = 0; id < receivers; id++) {
+      lights[id]->Poll();
+      uint8_t shown = lights[id]->State(id);
+      if (shown != last_shown[id]) {
+        light_changes++;
+        last_shown[id] = shown;
+      }
+      if (shown != status[id] - STATUS_OFF) {
+        wrong_ms[id]++;
+      }
+      if (red_at[id] >= 0 && shown == TALLY_FRAME_PROGRAM) {
+        to_red.push_back(t - red_at[id]);
+        red_at[id] = -1;
+      }
+      if (green_at[id] >= 0 && shown == TALLY_FRAME_PREVIEW) {
+        to_green.push_back(t - green_at[id]);
+        green_at[id] = -1;
+      }
+    }
+    clock.Advance(1000);
+  }
+
+  const RfStats& stats = link.Stats();
+  printf("%d receivers, %d s, byte error rate 0 to %.3f, %s\n", receivers,
+         seconds, ber, acks ? "acks" : "no acks");
+  printf("airtime: frames %.1f B/s, acks %.1f B/s, %lu collisions\n",
+         (double)frame_bytes / seconds, (double)ack_bytes / seconds,
+         collisions);
+  printf("sent: %u deltas (%u program first, %u changes merged), %u repeats, "
+         "%u retransmits, %u keyframes\n",
+         stats.deltas, stats.programs, stats.merged, stats.repeats,
+         stats.retransmits, stats.keyframes);
+  printf("lights changed %lu times for %lu changes at the switcher\n",
+         light_changes, switcher_changes);
+  PrintLatency("to red", to_red);
+  PrintLatency("to green", to_green);
+  printf("receiver  wrong light  lost (real)  lost (acked)  frames  acks"
+         "  missed acks\n");
+  for (int id = 0; id < receivers; id++) {
+    const RfReceiver& seen = link.Receiver(id);
+    printf("%8d  %10.2f%%  %11u  %12u  %6u  %4u  %11u\n", id,
+           100.0 * wrong_ms[id] / (seconds * 1000L), lights[id]->Lost(),
+           seen.lost, seen.frames, seen.acks, seen.missed_acks);
+  }
+  return 0;
+}
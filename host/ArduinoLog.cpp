@@ -0,0 +1,97 @@
+#include "ArduinoLog.h"
+
+Logging Log;
+
+void Logging::begin(int level, Print* output, bool showLevel) {
+  _level = level;
+  _logOutput = output;
+  _showLevel = showLevel;
+}
+
+#define LOG_METHOD(name, level)          \
+  void Logging::name(const char* format, ...) { \
+    va_list args;                        \
+    va_start(args, format);              \
+    print(level, format, args);          \
+    va_end(args);                        \
+  }
+
+LOG_METHOD(fatal, LOG_LEVEL_FATAL)
+LOG_METHOD(error, LOG_LEVEL_ERROR)
+LOG_METHOD(warning, LOG_LEVEL_WARNING)
+LOG_METHOD(notice, LOG_LEVEL_NOTICE)
+LOG_METHOD(trace, LOG_LEVEL_TRACE)
+LOG_METHOD(verbose, LOG_LEVEL_VERBOSE)
+
+void Logging::print(int level, const char* format, va_list args) {
+  if (!_logOutput || level > _level) return;
+  if (_showLevel) {
+    static const char levels[] = "FEWNTV";
+    _logOutput->print(levels[level - 1]);
+    _logOutput->print(": ");
+  }
+  va_list copy;
+  va_copy(copy, args);
+  for (; *format != 0; ++format) {
+    if (*format == '%') {
+      ++format;
+      printFormat(*format, &copy);
+      if (*format == 0) break;
+    } else {
+      _logOutput->print(*format);
+    }
+  }
+  va_end(copy);
+}
+
+void Logging::printFormat(char format, va_list* args) {
+  switch (format) {
+    case '%':
+      _logOutput->print('%');
+      break;
+    case 's':
+    case 'S':
+      _logOutput->print(va_arg(*args, const char*));
+      break;
+    case 'd':
+    case 'i':
+      _logOutput->print(va_arg(*args, int), DEC);
+      break;
+    case 'u':
+      _logOutput->print(va_arg(*args, unsigned int), DEC);
+      break;
+    case 'D':
+    case 'F':
+      _logOutput->print(va_arg(*args, double));
+      break;
+    case 'x':
+      _logOutput->print(va_arg(*args, int), HEX);
+      break;
+    case 'X':
+      _logOutput->print("0x");
+      _logOutput->print(va_arg(*args, int), HEX);
+      break;
+    case 'b':
+      _logOutput->print(va_arg(*args, int), BIN);
+      break;
+    case 'B':
+      _logOutput->print("0b");
+      _logOutput->print(va_arg(*args, int), BIN);
+      break;
+    case 'l':
+      _logOutput->print(va_arg(*args, long), DEC);
+      break;
+    case 'c':
+      _logOutput->print((char)va_arg(*args, int));
+      break;
+    case 't':
+      _logOutput->print(va_arg(*args, int) ? 'T' : 'F');
+      break;
+    case 'T':
+      _logOutput->print(va_arg(*args, int) ? "true" : "false");
+      break;
+    case 'p':
+      _logOutput->print(*va_arg(*args, Printable*));
+      break;
+  }
+}
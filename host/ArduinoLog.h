@@ -0,0 +1,47 @@
+/**
+ * Host stand-in for thijse/Arduino-Log with the same format specifiers:
+ * %s %S (string), %d %i (int), %l (long), %u, %x %X (hex), %b (binary),
+ * %c (char), %t %T (bool), %F (double) and %p (Printable).
+ */
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include <stdarg.h>
+
+#include "Arduino.h"
+
+#define LOG_LEVEL_SILENT 0
+#define LOG_LEVEL_FATAL 1
+#define LOG_LEVEL_ERROR 2
+#define LOG_LEVEL_WARNING 3
+#define LOG_LEVEL_NOTICE 4
+#define LOG_LEVEL_TRACE 5
+#define LOG_LEVEL_VERBOSE 6
+
+#define CR "\n"
+
+class Logging {
+ private:
+  int _level = LOG_LEVEL_SILENT;
+  bool _showLevel = true;
+  Print* _logOutput = nullptr;
+
+  void print(int level, const char* format, va_list args);
+  void printFormat(char format, va_list* args);
+
+ public:
+  void begin(int level, Print* output, bool showLevel = true);
+  void setLevel(int level) { _level = level; }
+  int getLevel() const { return _level; }
+
+  void fatal(const char* format, ...);
+  void error(const char* format, ...);
+  void warning(const char* format, ...);
+  void notice(const char* format, ...);
+  void trace(const char* format, ...);
+  void verbose(const char* format, ...);
+};
+
+extern Logging Log;
+
+#endif
@@ -0,0 +1,247 @@
+#include "Ethernet.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "SPI.h"
+#include "hal.h"
+
+EthernetClass Ethernet;
+SPIClass SPI;
+
+static uint8_t sockets_in_use = 0;
+
+uint8_t EthernetClass::socketsInUse() { return sockets_in_use; }
+
+static int OpenSocket(int type) {
+  if (sockets_in_use >= MAX_SOCK_NUM) {
+    fprintf(stderr, "Ethernet: all %d sockets in use\n", MAX_SOCK_NUM);
+    return -1;
+  }
+  int fd = socket(AF_INET, type | SOCK_NONBLOCK, 0);
+  if (fd >= 0) sockets_in_use++;
+  return fd;
+}
+
+static void CloseSocket(int fd) {
+  close(fd);
+  sockets_in_use--;
+}
+
+static struct sockaddr_in ToSockaddr(IPAddress ip, uint16_t port) {
+  static bool remap_init = false;
+  static bool remap = false;
+  static struct in_addr remote;
+  if (!remap_init) {
+    const char *env = getenv("HAL_REMOTE_IP");
+    remap = env && inet_pton(AF_INET, env, &remote) == 1;
+    remap_init = true;
+  }
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  if (remap) {
+    addr.sin_addr = remote;
+  } else {
+    uint8_t octets[4] = {ip[0], ip[1], ip[2], ip[3]};
+    memcpy(&addr.sin_addr, octets, 4);
+  }
+  return addr;
+}
+
+/**************
+ * EthernetUDP
+ **************/
+
+uint8_t EthernetUDP::begin(uint16_t port) {
+  if (_fd >= 0) stop();
+  _fd = OpenSocket(SOCK_DGRAM);
+  if (_fd < 0) return 0;
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(_fd, (struct sockaddr *)&addr, sizeof(addr))) {
+    perror("EthernetUDP: bind");
+    stop();
+    return 0;
+  }
+  _port = port;
+  _rx_length = _rx_offset = 0;
+  return 1;
+}
+
+void EthernetUDP::stop() {
+  if (_fd >= 0) CloseSocket(_fd);
+  _fd = -1;
+}
+
+int EthernetUDP::beginPacket(IPAddress ip, uint16_t port) {
+  _tx_ip = ip;
+  _tx_port = port;
+  _tx_length = 0;
+  return _fd >= 0;
+}
+
+size_t EthernetUDP::write(uint8_t byte) { return write(&byte, 1); }
+
+size_t EthernetUDP::write(const uint8_t *buffer, size_t size) {
+  if (size > (size_t)(BUFFER_SIZE - _tx_length)) {
+    size = BUFFER_SIZE - _tx_length;
+  }
+  memcpy(_tx + _tx_length, buffer, size);
+  _tx_length += size;
+  return size;
+}
+
+int EthernetUDP::endPacket() {
+  if (_fd < 0) return 0;
+  struct sockaddr_in addr = ToSockaddr(_tx_ip, _tx_port);
+  ssize_t sent = sendto(_fd, _tx, _tx_length, 0, (struct sockaddr *)&addr,
+                        sizeof(addr));
+  _tx_length = 0;
+  return sent >= 0;
+}
+
+int EthernetUDP::parsePacket() {
+  // discard any remaining bytes of the previous packet
+  _rx_length = _rx_offset = 0;
+  if (_fd < 0) return 0;
+
+  struct sockaddr_in from;
+  socklen_t from_length = sizeof(from);
+  ssize_t n = recvfrom(_fd, _rx, BUFFER_SIZE, 0, (struct sockaddr *)&from,
+                       &from_length);
+  if (n <= 0) return 0;
+
+  // the 8-byte W5100 UDP header (remote ip, port, length)
+  hal::Spi().bytes += 8;
+  hal::Spi().bursts++;
+  _rx_length = n;
+  _remote_ip = IPAddress((const uint8_t *)&from.sin_addr.s_addr);
+  _remote_port = ntohs(from.sin_port);
+  return n;
+}
+
+int EthernetUDP::available() { return _rx_length - _rx_offset; }
+
+int EthernetUDP::read() {
+  uint8_t byte;
+  return (read(&byte, 1) == 1) ? byte : -1;
+}
+
+int EthernetUDP::read(unsigned char *buffer, size_t len) {
+  size_t remaining = _rx_length - _rx_offset;
+  if (remaining == 0) return -1;
+  if (len > remaining) len = remaining;
+  // like socketRecv(): a NULL buffer only advances the RX read pointer
+  if (buffer) {
+    memcpy(buffer, _rx + _rx_offset, len);
+    hal::Spi().bytes += len;
+  }
+  hal::Spi().bursts++;
+  _rx_offset += len;
+  return len;
+}
+
+int EthernetUDP::peek() {
+  return (_rx_offset < _rx_length) ? _rx[_rx_offset] : -1;
+}
+
+/**************
+ * EthernetClient
+ **************/
+
+int EthernetClient::connect(IPAddress ip, uint16_t port) {
+  if (_fd >= 0) stop();
+  _fd = OpenSocket(SOCK_STREAM);
+  if (_fd < 0) return 0;
+  // the W5100 sends each write at once, no Nagle: a println() is not held
+  // back waiting for the ack of its print()
+  int on = 1;
+  setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+  struct sockaddr_in addr = ToSockaddr(ip, port);
+  int rc = ::connect(_fd, (struct sockaddr *)&addr, sizeof(addr));
+  if (rc && errno == EINPROGRESS) {
+    // the W5100 library blocks for up to the connection timeout waiting for
+    // ESTABLISHED
+    struct pollfd pfd = {_fd, POLLOUT, 0};
+    int error = ETIMEDOUT;
+    socklen_t length = sizeof(error);
+    if (poll(&pfd, 1, _connection_timeout) == 1) {
+      getsockopt(_fd, SOL_SOCKET, SO_ERROR, &error, &length);
+    }
+    rc = error;
+  }
+  if (rc) {
+    stop();
+    return 0;
+  }
+  return 1;
+}
+
+uint8_t EthernetClient::connected() {
+  if (_fd < 0) return 0;
+  if (available() > 0) return 1;
+  uint8_t byte;
+  ssize_t n = recv(_fd, &byte, 1, MSG_PEEK);
+  return !(n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK));
+}
+
+void EthernetClient::stop() {
+  if (_fd >= 0) CloseSocket(_fd);
+  _fd = -1;
+  _peek = -1;
+}
+
+size_t EthernetClient::write(uint8_t byte) { return write(&byte, 1); }
+
+size_t EthernetClient::write(const uint8_t *buffer, size_t size) {
+  if (_fd < 0) return 0;
+  ssize_t n = send(_fd, buffer, size, MSG_NOSIGNAL);
+  return n < 0 ? 0 : n;
+}
+
+int EthernetClient::available() {
+  if (_fd < 0) return 0;
+  int pending = 0;
+  ioctl(_fd, FIONREAD, &pending);
+  return pending + (_peek >= 0 ? 1 : 0);
+}
+
+int EthernetClient::read() {
+  uint8_t byte;
+  return (read(&byte, 1) == 1) ? byte : -1;
+}
+
+int EthernetClient::read(uint8_t *buffer, size_t size) {
+  if (_fd < 0 || size == 0) return -1;
+  size_t count = 0;
+  if (_peek >= 0) {
+    buffer[count++] = _peek;
+    _peek = -1;
+  }
+  if (count < size) {
+    ssize_t n = recv(_fd, buffer + count, size - count, 0);
+    if (n > 0) count += n;
+  }
+  return count ? (int)count : -1;
+}
+
+int EthernetClient::peek() {
+  if (_peek < 0) _peek = read();
+  return _peek;
+}
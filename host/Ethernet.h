@@ -0,0 +1,116 @@
+/**
+ * Host stand-in for the Arduino Ethernet library (W5100 shield).
+ *
+ * EthernetUDP and EthernetClient map onto POSIX UDP and TCP sockets. Like the
+ * W5100, at most MAX_SOCK_NUM sockets can be open at the same time, so a
+ * driver that leaks sockets fails the same way it would on the shield.
+ * UDP receive traffic is counted in hal::Spi().
+ * Set HAL_REMOTE_IP to redirect every outbound address (e.g. 127.0.0.1).
+ */
+#ifndef ethernet_h_
+#define ethernet_h_
+
+#include <stdint.h>
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include "Stream.h"
+
+#define MAX_SOCK_NUM 4
+
+enum EthernetLinkStatus { Unknown, LinkON, LinkOFF };
+
+enum EthernetHardwareStatus {
+  EthernetNoHardware,
+  EthernetW5100,
+  EthernetW5200,
+  EthernetW5500
+};
+
+class EthernetClass {
+ private:
+  IPAddress _local_ip;
+
+ public:
+  void init(uint8_t /*sspin*/ = 10) {}
+  void begin(uint8_t * /*mac*/, IPAddress ip) { _local_ip = ip; }
+  int maintain() { return 0; }
+  EthernetLinkStatus linkStatus() { return LinkON; }
+  EthernetHardwareStatus hardwareStatus() { return EthernetW5100; }
+  IPAddress localIP() { return _local_ip; }
+
+  // host only: sockets currently held, out of MAX_SOCK_NUM
+  static uint8_t socketsInUse();
+};
+
+extern EthernetClass Ethernet;
+
+class EthernetUDP : public Stream {
+ private:
+  static const uint16_t BUFFER_SIZE = 2048;
+
+  int _fd = -1;
+  uint16_t _port = 0;
+  uint8_t _rx[BUFFER_SIZE];
+  uint16_t _rx_length = 0;
+  uint16_t _rx_offset = 0;
+  IPAddress _remote_ip;
+  uint16_t _remote_port = 0;
+  uint8_t _tx[BUFFER_SIZE];
+  uint16_t _tx_length = 0;
+  IPAddress _tx_ip;
+  uint16_t _tx_port = 0;
+
+ public:
+  uint8_t begin(uint16_t port);
+  void stop();
+
+  int beginPacket(IPAddress ip, uint16_t port);
+  int endPacket();
+  size_t write(uint8_t byte) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+
+  int parsePacket();
+  int available() override;
+  int read() override;
+  int read(unsigned char *buffer, size_t len);
+  int read(char *buffer, size_t len) {
+    return read((unsigned char *)buffer, len);
+  }
+  int peek() override;
+  void flush() override {}
+
+  IPAddress remoteIP() { return _remote_ip; }
+  uint16_t remotePort() { return _remote_port; }
+};
+
+class EthernetClient : public Stream {
+ private:
+  int _fd = -1;
+  int _peek = -1;
+  uint16_t _connection_timeout = 1000;
+
+ public:
+  EthernetClient() {}
+
+  // like Ethernet 2.x: bounds how long connect() (and stop()) may block
+  void setConnectionTimeout(uint16_t timeout) { _connection_timeout = timeout; }
+  int connect(IPAddress ip, uint16_t port);
+  uint8_t connected();
+  void stop();
+
+  size_t write(uint8_t byte) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+
+  int available() override;
+  int read() override;
+  int read(uint8_t *buffer, size_t size);
+  int peek() override;
+  void flush() override {}
+
+  operator bool() { return _fd >= 0; }
+};
+
+#endif
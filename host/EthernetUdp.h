@@ -0,0 +1,6 @@
+#ifndef ethernetudp_h
+#define ethernetudp_h
+
+#include "Ethernet.h"
+
+#endif
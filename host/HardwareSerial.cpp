@@ -0,0 +1,25 @@
+#include "HardwareSerial.h"
+
+#include <stdio.h>
+
+#include "Arduino.h"
+
+HardwareSerial Serial;
+
+void HardwareSerial::flush() { fflush(stdout); }
+
+size_t HardwareSerial::write(uint8_t c) { return fputc(c, stdout) == EOF ? 0 : 1; }
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  return fwrite(buffer, 1, size, stdout);
+}
+
+size_t IPAddress::printTo(Print &p) const {
+  size_t n = 0;
+  for (int i = 0; i < 3; i++) {
+    n += p.print(_address[i], DEC);
+    n += p.print('.');
+  }
+  n += p.print(_address[3], DEC);
+  return n;
+}
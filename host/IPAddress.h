@@ -0,0 +1,34 @@
+/**
+ * Host stand-in for the Arduino IPAddress class.
+ */
+#ifndef IPAddress_h
+#define IPAddress_h
+
+#include <stdint.h>
+
+#include "Print.h"
+
+class IPAddress : public Printable {
+ private:
+  uint8_t _address[4];
+
+ public:
+  IPAddress() : _address{0, 0, 0, 0} {}
+  IPAddress(uint8_t first_octet, uint8_t second_octet, uint8_t third_octet,
+            uint8_t fourth_octet)
+      : _address{first_octet, second_octet, third_octet, fourth_octet} {}
+  explicit IPAddress(const uint8_t *address)
+      : _address{address[0], address[1], address[2], address[3]} {}
+
+  uint8_t operator[](int index) const { return _address[index]; }
+  uint8_t &operator[](int index) { return _address[index]; }
+  bool operator==(const IPAddress &addr) const {
+    return _address[0] == addr[0] && _address[1] == addr[1] &&
+           _address[2] == addr[2] && _address[3] == addr[3];
+  }
+  bool operator!=(const IPAddress &addr) const { return !(*this == addr); }
+
+  size_t printTo(Print &p) const override;
+};
+
+#endif
@@ -0,0 +1,16 @@
+/**
+ * Host stand-in for the SPI library; the W5100 is replaced by sockets, so
+ * there is nothing to clock out.
+ */
+#ifndef _SPI_H_INCLUDED
+#define _SPI_H_INCLUDED
+
+class SPIClass {
+ public:
+  static void begin() {}
+  static void end() {}
+};
+
+extern SPIClass SPI;
+
+#endif
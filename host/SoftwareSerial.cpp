@@ -0,0 +1,96 @@
+#include "SoftwareSerial.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+// not Arduino.h: the B0/B110/B1000000 literals of its binary.h clash with
+// the baud rate constants of <termios.h>
+#include "hal.h"
+
+SoftwareSerial::SoftwareSerial(uint8_t receivePin, uint8_t transmitPin,
+                               bool /*inverse_logic*/)
+    : _receivePin(receivePin), _transmitPin(transmitPin) {}
+
+SoftwareSerial::~SoftwareSerial() { end(); }
+
+void SoftwareSerial::begin(long speed) {
+  if (_fd >= 0) return;
+  _speed = speed;
+  _fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (_fd < 0 || grantpt(_fd) || unlockpt(_fd)) {
+    perror("SoftwareSerial: posix_openpt");
+    end();
+    return;
+  }
+  // raw 8N1 on the slave side so bytes such as STX/ACK pass untouched
+  int slave = open(ptsname(_fd), O_RDWR | O_NOCTTY);
+  if (slave >= 0) {
+    struct termios tio;
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    close(slave);
+  }
+
+  const char *dir = getenv("HAL_PTY_DIR");
+  if (dir) {
+    char link[256];
+    snprintf(link, sizeof(link), "%s/serial-%u-%u", dir, _receivePin,
+             _transmitPin);
+    unlink(link);
+    if (symlink(ptsname(_fd), link)) perror("SoftwareSerial: symlink");
+  }
+  fprintf(stderr, "SoftwareSerial(%u, %u) @%ld baud on %s\n", _receivePin,
+          _transmitPin, speed, ptsname(_fd));
+}
+
+void SoftwareSerial::end() {
+  if (_fd >= 0) close(_fd);
+  _fd = -1;
+  _peek = -1;
+}
+
+const char *SoftwareSerial::portName() const {
+  return (_fd >= 0) ? ptsname(_fd) : "";
+}
+
+int SoftwareSerial::available() {
+  if (_fd < 0) return 0;
+  int pending = 0;
+  ioctl(_fd, FIONREAD, &pending);
+  return pending + (_peek >= 0 ? 1 : 0);
+}
+
+int SoftwareSerial::read() {
+  if (_peek >= 0) {
+    int c = _peek;
+    _peek = -1;
+    return c;
+  }
+  uint8_t c;
+  if (_fd < 0 || ::read(_fd, &c, 1) != 1) return -1;
+  return c;
+}
+
+int SoftwareSerial::peek() {
+  if (_peek < 0) _peek = read();
+  return _peek;
+}
+
+size_t SoftwareSerial::write(uint8_t byte) { return write(&byte, 1); }
+
+size_t SoftwareSerial::write(const uint8_t *buffer, size_t size) {
+  if (_fd < 0) return 0;
+  // nobody listening on the slave side is the same as nobody listening on
+  // the wire: drop the bytes instead of blocking
+  ssize_t n = ::write(_fd, buffer, size);
+  if (_speed > 0) {
+    hal::GetClock().Sleep(size * 10000000ULL / _speed);
+  }
+  return n < 0 ? 0 : n;
+}
@@ -0,0 +1,47 @@
+/**
+ * Host stand-in for SoftwareSerial: each port is a pseudo terminal. begin()
+ * opens it and logs the slave path (e.g. /dev/pts/3) so a simulator or
+ * `screen` can attach to the other end. Writes take as long as they would on
+ * the wire (10 bits per byte at the configured baud rate), because the AVR
+ * implementation busy-waits with interrupts disabled while transmitting.
+ */
+#ifndef SoftwareSerial_h
+#define SoftwareSerial_h
+
+#include <stdint.h>
+
+#include "Stream.h"
+
+class SoftwareSerial : public Stream {
+ private:
+  uint8_t _receivePin;
+  uint8_t _transmitPin;
+  int _fd = -1;
+  int _peek = -1;
+  long _speed = 0;
+
+ public:
+  SoftwareSerial(uint8_t receivePin, uint8_t transmitPin,
+                 bool inverse_logic = false);
+  ~SoftwareSerial();
+
+  void begin(long speed);
+  void end();
+  bool listen() { return true; }
+  bool isListening() { return true; }
+  bool overflow() { return false; }
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t byte) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+
+  operator bool() { return _fd >= 0; }
+
+  // host only: path of the pty slave, empty before begin()
+  const char *portName() const;
+};
+
+#endif
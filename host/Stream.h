@@ -0,0 +1,29 @@
+/**
+ * Host stand-in for the Arduino Stream class.
+ */
+#ifndef Stream_h
+#define Stream_h
+
+#include "Print.h"
+#include "WString.h"
+
+class Stream : public Print {
+ protected:
+  unsigned long _timeout = 1000;  // same default as the AVR core
+  int timedRead();
+
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual void flush() {}
+
+  void setTimeout(unsigned long timeout) { _timeout = timeout; }
+  size_t readBytes(char *buffer, size_t length);
+  size_t readBytes(uint8_t *buffer, size_t length) {
+    return readBytes((char *)buffer, length);
+  }
+  String readStringUntil(char terminator);
+};
+
+#endif
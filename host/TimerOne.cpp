@@ -0,0 +1,38 @@
+#include "TimerOne.h"
+
+#include "hal.h"
+
+TimerOne Timer1;
+
+void TimerOne::initialize(unsigned long microseconds) {
+  setPeriod(microseconds);
+}
+
+void TimerOne::setPeriod(unsigned long microseconds) {
+  _period = microseconds ? microseconds : 1;
+  _next = hal::GetClock().Now() + _period;
+}
+
+void TimerOne::start() {
+  _next = hal::GetClock().Now() + _period;
+  _running = true;
+}
+
+void TimerOne::attachInterrupt(void (*isr)()) {
+  _isr = isr;
+  _running = true;
+}
+
+void TimerOne::attachInterrupt(void (*isr)(), unsigned long microseconds) {
+  setPeriod(microseconds);
+  attachInterrupt(isr);
+}
+
+void TimerOne::service() {
+  if (!_running || !_isr) return;
+  uint64_t now = hal::GetClock().Now();
+  if (now < _next) return;
+  // a late service call fires once, like a single latched interrupt flag
+  _next = now - (now - _next) % _period + _period;
+  _isr();
+}
@@ -0,0 +1,35 @@
+/**
+ * Host stand-in for the TimerOne library. The "interrupt" is not asynchronous:
+ * it runs from hal::RunTimers(), which the host main loop and delay() call.
+ */
+#ifndef TimerOne_h_
+#define TimerOne_h_
+
+#include <stdint.h>
+
+class TimerOne {
+ private:
+  void (*_isr)() = nullptr;
+  unsigned long _period = 1000000;  // microseconds
+  uint64_t _next = 0;
+  bool _running = false;
+
+ public:
+  void initialize(unsigned long microseconds = 1000000);
+  void setPeriod(unsigned long microseconds);
+  void start();
+  void stop() { _running = false; }
+  void resume() { _running = true; }
+  void restart() { start(); }
+  void attachInterrupt(void (*isr)());
+  void attachInterrupt(void (*isr)(), unsigned long microseconds);
+  void detachInterrupt() { _isr = nullptr; }
+  bool isRunning() const { return _running; }
+
+  // host only: fire the callback if its period has elapsed
+  void service();
+};
+
+extern TimerOne Timer1;
+
+#endif
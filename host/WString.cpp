@@ -0,0 +1,77 @@
+#include "WString.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+String::String(const char *cstr) { copy(cstr, strlen(cstr)); }
+
+String::String(const String &str) { copy(str._buffer, str._len); }
+
+String::~String() { free(_buffer); }
+
+String &String::operator=(const String &rhs) {
+  if (this != &rhs) copy(rhs._buffer, rhs._len);
+  return *this;
+}
+
+String &String::operator=(const char *cstr) {
+  return copy(cstr, strlen(cstr));
+}
+
+String &String::operator+=(char c) {
+  char buf[2] = {c, '\0'};
+  return concat(buf);
+}
+
+bool String::operator==(const String &rhs) const {
+  return _len == rhs._len && strcmp(c_str(), rhs.c_str()) == 0;
+}
+
+bool String::operator==(const char *cstr) const {
+  return strcmp(c_str(), cstr) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+  return (index < _len) ? _buffer[index] : 0;
+}
+
+int String::indexOf(char ch) const {
+  const char *found = strchr(c_str(), ch);
+  return found ? found - _buffer : -1;
+}
+
+int String::indexOf(const String &str) const {
+  const char *found = strstr(c_str(), str.c_str());
+  return found ? found - _buffer : -1;
+}
+
+bool String::startsWith(const String &prefix) const {
+  return _len >= prefix._len && strncmp(c_str(), prefix.c_str(), prefix._len) == 0;
+}
+
+String &String::concat(const char *cstr) {
+  unsigned int len = strlen(cstr);
+  if (reserve(_len + len)) {
+    memcpy(_buffer + _len, cstr, len + 1);
+    _len += len;
+  }
+  return *this;
+}
+
+String &String::copy(const char *cstr, unsigned int length) {
+  if (reserve(length)) {
+    memcpy(_buffer, cstr, length);
+    _buffer[length] = '\0';
+    _len = length;
+  }
+  return *this;
+}
+
+bool String::reserve(unsigned int size) {
+  if (_buffer && _capacity >= size) return true;
+  char *buffer = (char *)realloc(_buffer, size + 1);
+  if (!buffer) return false;
+  _buffer = buffer;
+  _capacity = size;
+  return true;
+}
@@ -0,0 +1,44 @@
+/**
+ * Host stand-in for the Arduino String class. Backed by the heap exactly like
+ * the AVR version, so allocation behaviour can be observed on the host.
+ */
+#ifndef String_class_h
+#define String_class_h
+
+#include <stddef.h>
+
+class String {
+ public:
+  String(const char *cstr = "");
+  String(const String &str);
+  ~String();
+
+  String &operator=(const String &rhs);
+  String &operator=(const char *cstr);
+  String &operator+=(const String &rhs) { return concat(rhs.c_str()); }
+  String &operator+=(const char *cstr) { return concat(cstr); }
+  String &operator+=(char c);
+
+  bool operator==(const String &rhs) const;
+  bool operator==(const char *cstr) const;
+  bool operator!=(const String &rhs) const { return !(*this == rhs); }
+
+  unsigned int length() const { return _len; }
+  const char *c_str() const { return _buffer; }
+  char charAt(unsigned int index) const;
+  char operator[](unsigned int index) const { return charAt(index); }
+  int indexOf(char ch) const;
+  int indexOf(const String &str) const;
+  bool startsWith(const String &prefix) const;
+
+ private:
+  String &concat(const char *cstr);
+  String &copy(const char *cstr, unsigned int length);
+  bool reserve(unsigned int size);
+
+  char *_buffer = nullptr;
+  unsigned int _capacity = 0;
+  unsigned int _len = 0;
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "hal.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#include "Arduino.h"
+#include "TimerOne.h"
+
+namespace hal {
+
+static SystemClock system_clock;
+static Clock* current_clock = &system_clock;
+static uint8_t pin_level[NUM_DIGITAL_PINS];
+static bool pin_level_init = false;
+
+uint64_t SystemClock::Now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+void SystemClock::Sleep(uint64_t us) {
+  struct timespec ts;
+  ts.tv_sec = us / 1000000ULL;
+  ts.tv_nsec = (us % 1000000ULL) * 1000;
+  nanosleep(&ts, nullptr);
+}
+
+void SetClock(Clock* clock) {
+  current_clock = clock ? clock : &system_clock;
+}
+
+Clock& GetClock() { return *current_clock; }
+
+static void InitPins() {
+  if (!pin_level_init) {
+    memset(pin_level, HIGH, sizeof(pin_level));
+    pin_level_init = true;
+  }
+}
+
+void SetPin(uint8_t pin, uint8_t level) {
+  InitPins();
+  if (pin < NUM_DIGITAL_PINS) {
+    pin_level[pin] = level;
+  }
+}
+
+uint8_t GetPin(uint8_t pin) {
+  InitPins();
+  return (pin < NUM_DIGITAL_PINS) ? pin_level[pin] : LOW;
+}
+
+void RunTimers() { Timer1.service(); }
+
+SpiCounters& Spi() {
+  static SpiCounters counters = {0, 0};
+  return counters;
+}
+
+void InitFromEnvironment() {
+  const char* pins = getenv("HAL_PIN_LOW");
+  while (pins && *pins) {
+    char* end;
+    long pin = strtol(pins, &end, 10);
+    if (end == pins) break;
+    SetPin(pin, LOW);
+    pins = (*end == ',') ? end + 1 : end;
+  }
+}
+
+}  // namespace hal
+
+unsigned long millis() { return (uint32_t)(hal::GetClock().Now() / 1000); }
+
+unsigned long micros() { return (uint32_t)hal::GetClock().Now(); }
+
+void delay(unsigned long ms) {
+  uint64_t until = hal::GetClock().Now() + (uint64_t)ms * 1000;
+  // keep the timer "interrupt" alive while the sketch is blocked
+  while (hal::GetClock().Now() < until) {
+    uint64_t left = until - hal::GetClock().Now();
+    hal::GetClock().Sleep(left < 1000 ? left : 1000);
+    hal::RunTimers();
+  }
+}
+
+void delayMicroseconds(unsigned int us) { hal::GetClock().Sleep(us); }
+
+void yield() { hal::RunTimers(); }
+
+void pinMode(uint8_t /*pin*/, uint8_t /*mode*/) {}
+
+int digitalRead(uint8_t pin) { return hal::GetPin(pin); }
+
+void digitalWrite(uint8_t pin, uint8_t val) { hal::SetPin(pin, val); }
+
+long random(long howbig) { return howbig ? rand() % howbig : 0; }
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed) { srand(seed); }
@@ -0,0 +1,84 @@
+/**
+ * Host hardware abstraction layer.
+ *
+ * The Arduino-facing headers in this directory (Arduino.h, Ethernet.h,
+ * SoftwareSerial.h, TimerOne.h, ...) are thin shims over the hooks declared
+ * here, so a host program or simulation can swap the clock, drive the input
+ * pins and run the timer "interrupts" at well defined points.
+ */
+#ifndef HAL_h
+#define HAL_h
+
+#include <stdint.h>
+
+namespace hal {
+
+/**
+ * @brief time source behind millis()/micros()/delay()
+ */
+class Clock {
+ public:
+  virtual ~Clock() {}
+  // monotonic microseconds since an arbitrary epoch
+  virtual uint64_t Now() = 0;
+  // block (or pretend to block) for the given amount of microseconds
+  virtual void Sleep(uint64_t us) = 0;
+};
+
+/**
+ * @brief wall clock backed by CLOCK_MONOTONIC, used by default
+ */
+class SystemClock : public Clock {
+ public:
+  uint64_t Now() override;
+  void Sleep(uint64_t us) override;
+};
+
+/**
+ * @brief clock that only moves when told to, for deterministic simulations
+ */
+class ManualClock : public Clock {
+ private:
+  uint64_t _now = 0;
+
+ public:
+  uint64_t Now() override { return _now; }
+  void Sleep(uint64_t us) override { _now += us; }
+  void Advance(uint64_t us) { _now += us; }
+};
+
+void SetClock(Clock* clock);
+Clock& GetClock();
+
+// level returned by digitalRead(); every pin idles HIGH (pulled up)
+void SetPin(uint8_t pin, uint8_t level);
+uint8_t GetPin(uint8_t pin);
+
+// run the periodic callbacks registered through TimerOne that are due
+void RunTimers();
+
+/**
+ * @brief W5100 receive traffic, counted by the Ethernet shim
+ *
+ * bytes is the payload moved from the chip's RX buffer into MCU memory
+ * (the W5100 wraps every one of them in a 4-byte SPI frame), bursts is the
+ * number of socket reads issued. A discard (read into NULL) only moves the
+ * RX pointer, so it counts as a burst without payload.
+ */
+struct SpiCounters {
+  uint32_t bytes;
+  uint32_t bursts;
+};
+
+SpiCounters& Spi();
+
+/**
+ * @brief Applies HAL_PIN_LOW=3,4 (pins that read LOW, i.e. the device
+ * selector). HAL_REMOTE_IP and HAL_PTY_DIR are read by the Ethernet and
+ * SoftwareSerial shims themselves.
+ */
+void InitFromEnvironment();
+
+}  // namespace hal
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * Host entry point: runs the unmodified transmitter sketch on Linux and
+ * reports per-iteration latency of loop().
+ *
+ * usage: tally_host [--iterations N] [--report-ms N]
+ *   --iterations N  stop after N loop() calls (default: run forever)
+ *   --report-ms N   print latency statistics every N ms (default: 5000)
+ */
+#include <signal.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "Arduino.h"
+#include "hal.h"
+
+#include "../transmitter.ino"
+
+static volatile sig_atomic_t stop_requested = 0;
+
+// the first signal lets the current loop() finish, a second one kills us
+// (the sketch may legitimately block, e.g. while reconnecting)
+static void OnSignal(int sig) {
+  stop_requested = 1;
+  signal(sig, SIG_DFL);
+}
+
+static void Report(std::vector<uint32_t>& samples, unsigned long total) {
+  if (samples.empty()) return;
+  std::sort(samples.begin(), samples.end());
+  uint64_t sum = 0;
+  for (uint32_t sample : samples) sum += sample;
+  fprintf(stderr,
+          "loop(): %lu iterations, last %zu: min %u us, mean %llu us, "
+          "p50 %u us, p99 %u us, max %u us\n",
+          total, samples.size(), samples.front(),
+          (unsigned long long)(sum / samples.size()),
+          samples[samples.size() / 2], samples[samples.size() * 99 / 100],
+          samples.back());
+  samples.clear();
+}
+
+int main(int argc, char** argv) {
+  unsigned long iterations = 0;
+  unsigned long report_ms = 5000;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (!strcmp(argv[i], "--iterations")) {
+      iterations = strtoul(argv[i + 1], nullptr, 10);
+    } else if (!strcmp(argv[i], "--report-ms")) {
+      report_ms = strtoul(argv[i + 1], nullptr, 10);
+    } else {
+      fprintf(stderr, "unknown option %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  signal(SIGINT, OnSignal);
+  signal(SIGTERM, OnSignal);
+  hal::InitFromEnvironment();
+
+  setup();
+
+  std::vector<uint32_t> samples;
+  unsigned long total = 0;
+  uint64_t last_report = hal::GetClock().Now();
+  while (!stop_requested && (iterations == 0 || total < iterations)) {
+    uint64_t start = hal::GetClock().Now();
+    loop();
+    // timer "interrupts" due now steal time from this iteration
+    hal::RunTimers();
+    uint64_t end = hal::GetClock().Now();
+    samples.push_back((uint32_t)(end - start));
+    total++;
+
+    if (end - last_report >= report_ms * 1000ULL) {
+      Report(samples, total);
+      last_report = end;
+    }
+  }
+  Report(samples, total);
+  return 0;
+}
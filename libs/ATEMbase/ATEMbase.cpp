@@ -77,6 +77,7 @@ void ATEMbase::connect() {
  * If useFixedPortNumber is true, the same port number will be used on subsequent connects, otherwise - and recommended - a new, random port number is used.
  */
 void ATEMbase::connect(const boolean useFixedPortNumber) {
+	neverConnected = false;			// runLoop() must not send a second hello from yet another port
 	_localPacketIdCounter = 0;		// Init localPacketIDCounter to 0;
 	_initPayloadSent = false;		// Will be true after initial payload of data is delivered (regular 12-byte ping packages are transmitted.)
 	_hasInitialized = false;		// Will be true after initial payload of data is resent and received well
@@ -106,6 +107,17 @@ void ATEMbase::connect(const boolean useFixedPortNumber) {
 	_sendPacketBuffer(20);  
 }
 
+/**
+ * Closes the UDP socket, so its W5100 socket is free for something else. The switcher drops the session once it gets no more answers.
+ * Stop calling runLoop() after this; connect() starts over.
+ */
+void ATEMbase::disconnect() {
+	_Udp.stop();
+	_initPayloadSent = false;
+	_hasInitialized = false;
+	_isConnected = false;
+}
+
 /**
  * Keeps connection to the switcher alive
  * Therefore: Call this in the Arduino loop() function and make sure it gets call at least 2 times a second
@@ -395,6 +407,82 @@ bool ATEMbase::_readToPacketBuffer(uint8_t maxBytes) {
 	}
 }
 
+/**
+ * Discards the rest of the current segment without copying it to the buffer.
+ * On the W5100 a read into NULL only moves the RX read pointer, so the whole
+ * remainder costs one socket operation instead of one SPI burst per 96 bytes.
+ */
+void ATEMbase::_skipPacketBuffer() {
+	int remainingBytes = _cmdLength-8-_cmdPointer;
+
+	if (remainingBytes>0)	{
+		#ifdef ESP8266
+		while (_readToPacketBuffer())	{}	// WiFiUDP can't discard, so read it out
+		#else
+		_Udp.read((uint8_t *)NULL, remainingBytes);
+		_cmdPointer+= remainingBytes;
+		#endif
+	}
+}
+
+/**
+ * Parses a TlIn (tally by index) segment whose first bytes _readToPacketBuffer() has read, streaming the rest through _packetBuffer.
+ * The flags of the first maxSources sources go to flags[]; the bit of a source in changed[] is set when its flags change, and so is *tallyChanged.
+ * Returns the number of sources reported by the switcher, the flags past maxSources are left for _parsePacket() to skip.
+ */
+uint16_t ATEMbase::_parseTallyByIndex(uint8_t *flags, uint8_t *changed, uint16_t maxSources, bool *tallyChanged)	{
+	uint16_t reported = word(_packetBuffer[0],_packetBuffer[1]);
+	uint16_t sources = reported<maxSources ? reported : maxSources;
+
+	// bufferOffset is the segment offset of _packetBuffer[0]
+	uint16_t bufferOffset = 0;
+	for(uint16_t a=0;a<sources;a++)	{
+		if (2+a >= _cmdPointer)	{
+			bufferOffset = _cmdPointer;
+			_readToPacketBuffer();
+			if (2+a >= _cmdPointer)	break;	// Segment shorter than announced
+		}
+		if (flags[a] != _packetBuffer[2+a-bufferOffset])	{
+			changed[a>>3] |= B1<<(a&0x07);
+			*tallyChanged = true;
+		}
+		flags[a] = _packetBuffer[2+a-bufferOffset];
+	}
+	return reported;
+}
+
+/**
+ * Parses a TlSr (tally by source) segment whose first bytes _readToPacketBuffer() has read in whole 3-byte entries after the source count.
+ * Flags are stored 2 bits per getVideoSrcIndex() in flags[]; sources not in that table are ignored.
+ * Returns true if any stored flags changed.
+ */
+bool ATEMbase::_parseTallyBySource(uint8_t *flags)	{
+	uint16_t sources = word(_packetBuffer[0],_packetBuffer[1]);
+	bool tallyChanged = false;
+
+	// Entries are 2 bytes video source + 1 byte flags; the reads are sized so they never straddle _packetBuffer
+	uint16_t bufferOffset = 0;
+	for(uint16_t a=0;a<sources;a++)	{
+		uint16_t entry = 2+a*3;
+		if (entry+3 > _cmdPointer)	{
+			bufferOffset = _cmdPointer;
+			_readToPacketBuffer((ATEM_packetBufferLength/3)*3);
+			if (entry+3 > _cmdPointer)	break;	// Segment shorter than announced
+		}
+		uint16_t videoSource = word(_packetBuffer[entry-bufferOffset], _packetBuffer[entry-bufferOffset+1]);
+		uint8_t srcIndex = getVideoSrcIndex(videoSource);
+		if (srcIndex==0 && videoSource!=0)	continue;	// Not in the getVideoSrcIndex() table
+
+		uint8_t shift = (srcIndex&0x03)<<1;
+		uint8_t value = _packetBuffer[entry-bufferOffset+2] & 0x03;
+		if (((flags[srcIndex>>2]>>shift) & 0x03) != value)	{
+			flags[srcIndex>>2] = (flags[srcIndex>>2] & ~(0x03<<shift)) | (value<<shift);
+			tallyChanged = true;
+		}
+	}
+	return tallyChanged;
+}
+
 /**
  * If a package longer than a normal acknowledgement is received from the ATEM Switcher we must read through the contents.
  * Usually such a package contains updated state information about the mixer
@@ -410,6 +498,7 @@ void ATEMbase::_parsePacket(uint16_t packetLength)	{
         _Udp.read(_packetBuffer, 8);
         _cmdLength = word(_packetBuffer[0], _packetBuffer[1]);
 		_cmdPointer = 0;
+		_cmdId = ATEM_cmd(_packetBuffer[4], _packetBuffer[5], _packetBuffer[6], _packetBuffer[7]);
         
 			// Get the "command string", basically this is the 4 char variable name in the ATEM memory holding the various state values of the system:
         char cmdStr[] = { 
@@ -419,7 +508,7 @@ void ATEMbase::_parsePacket(uint16_t packetLength)	{
         if (_cmdLength>8)  {
 			_parseGetCommands(cmdStr);
 
-			while (_readToPacketBuffer())	{}	// Empty, if not done yet.
+			_skipPacketBuffer();	// Discard what the parser didn't read
 			indexPointer+=_cmdLength;
         } else { 
       		indexPointer = 2000;
@@ -437,24 +526,18 @@ void ATEMbase::_parsePacket(uint16_t packetLength)	{
 
 /**
  * This method should be overloaded in subclasses in order to handle specific get-commands
+ * Whatever the parser leaves unread of the segment is skipped by _parsePacket(), so commands that are not of interest should not be read at all.
  */
 void ATEMbase::_parseGetCommands(const char *cmdString)	{
 //	uint8_t mE, keyer, mediaPlayer, aUXChannel, windowIndex, multiViewer, memory, colorGenerator, box;
 //	uint16_t audioSource, videoSource;
 //	long temp;
-	
-	uint8_t numberOfReads=1;
-	while(_readToPacketBuffer())	{
-		numberOfReads++;
-	}
 
 	#if ATEM_debug
  	if (_serialOutput & 0x80) {
 		Serial.print(cmdString);
 		Serial.print(", len: ");
-		Serial.print(_cmdLength);
-		Serial.print(", rds: ");
-		Serial.println(numberOfReads);
+		Serial.println(_cmdLength);
 	}
 	#endif
 }
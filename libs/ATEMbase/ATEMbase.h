@@ -49,6 +49,14 @@ you can keep a clear conscience: http://skaarhoj.com/about/licenses/
 #define ATEM_maxInitPackageCount 40		// The maximum number of initialization packages. By observation on a 2M/E 4K can be up to (not fixed!) 32. We allocate a f more then...
 #define ATEM_packetBufferLength 96		// Size of packet buffer
 
+#ifndef ATEM_maxTallySources
+#define ATEM_maxTallySources 20		// Number of sources stored from TlIn (tally by index). Larger switchers report more (40+ on a 2 M/E 4K rig); the extra ones are read past. 1 byte of SRAM per source. It sizes members of ATEMstd and ATEMtally, so raise it here or as a global build flag (-D for every file, e.g. build.extra_flags); a #define in the sketch does not reach the library, which then is compiled with a different class layout.
+#endif
+
+#define ATEM_tallyBySourceIndexes 47	// Range of getVideoSrcIndex(), the sources kept from TlSr (tally by source)
+
+#define ATEM_cmd(a,b,c,d) (((uint32_t)(a)<<24) | ((uint32_t)(b)<<16) | ((uint32_t)(c)<<8) | (uint32_t)(d))	// 4-char command name packed big-endian into a uint32_t, usable as a switch case label
+
 #define ATEM_debug 0				// If "1" (true), more debugging information may hit the serial monitor, in particular when _serialDebug = 0x80. Setting this to "0" is recommended for production environments since it saves on flash memory.
 
 class ATEMbase
@@ -80,6 +88,7 @@ class ATEMbase
 
 	uint16_t _cmdLength;				// Used when parsing packets
 	uint16_t _cmdPointer;				// Used when parsing packets
+	uint32_t _cmdId;					// Used when parsing packets; the command string packed by ATEM_cmd()
 
 	bool _cBundle;				// If set, we are building a set-command bundle.
 	uint8_t _cBBO;		// Bundle Buffer Offset; This is an offset if you want to add more commands.
@@ -95,6 +104,7 @@ class ATEMbase
 	void begin(const IPAddress ip, const uint16_t localPort);
     void connect();
     void connect(const boolean useFixedPortNumber);
+    void disconnect();
     void runLoop();
 	void runLoop(uint16_t delayTime);
 		
@@ -134,6 +144,9 @@ class ATEMbase
 	virtual void _parseGetCommands(const char *cmdString);
 	bool _readToPacketBuffer();
 	bool _readToPacketBuffer(uint8_t maxBytes);
+	void _skipPacketBuffer();
+	uint16_t _parseTallyByIndex(uint8_t *flags, uint8_t *changed, uint16_t maxSources, bool *tallyChanged);
+	bool _parseTallyBySource(uint8_t *flags);
 	void _prepareCommandPacket(const char *cmdString, uint8_t cmdBytes, bool indexMatch=true);
 	void _finishCommandPacket();
 };
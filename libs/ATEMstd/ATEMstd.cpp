@@ -32,7 +32,17 @@ you can keep a clear conscience: http://skaarhoj.com/about/licenses/
 /**
  * Constructor (using arguments is deprecated! Use begin() instead)
  */
-ATEMstd::ATEMstd(){}
+ATEMstd::ATEMstd(){
+	atemTallyByIndexSources = 0;
+	memset(atemTallyByIndexTallyFlags, 0, sizeof(atemTallyByIndexTallyFlags));
+	memset(atemTallyByIndexChanged, 0, sizeof(atemTallyByIndexChanged));
+	atemTallyByIndexGeneration = 0;
+	memset(atemTallyBySourceTallyFlags, 0, sizeof(atemTallyBySourceTallyFlags));
+	atemTallyBySourceGeneration = 0;
+	memset(atemProgramInputVideoSource, 0, sizeof(atemProgramInputVideoSource));
+	memset(atemPreviewInputVideoSource, 0, sizeof(atemPreviewInputVideoSource));
+	atemInputVideoSourceGeneration = 0;
+}
 
 
 
@@ -430,19 +440,45 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 			uint8_t mE,keyer,colorGenerator,aUXChannel,mediaPlayer,macroIndex;
 			uint16_t index,audioSource,sources;
 			long temp;
-			uint8_t readBytesForTlSr;
-
-			if (!strcmp_P(cmdStr, PSTR("AMLv")))	{
-				_readToPacketBuffer(36);
-			} else if (!strcmp_P(cmdStr, PSTR("TlSr")))	{
-				readBytesForTlSr = ((ATEM_packetBufferLength-2)/3)*3+2;
-				_readToPacketBuffer(readBytesForTlSr);
-			} else {
-				_readToPacketBuffer();	// Default
-			}
-
-
-			if (!strcmp_P(cmdStr, PSTR("_pin")))	{
+			bool tallyChanged = false;
+
+			switch (_cmdId)	{
+				case ATEM_cmd('A','M','L','v'):
+					_readToPacketBuffer(36);
+					break;
+				case ATEM_cmd('T','l','S','r'):
+					_readToPacketBuffer(((ATEM_packetBufferLength-2)/3)*3+2);	// Sources count plus whole 3-byte entries
+					break;
+				case ATEM_cmd('_','p','i','n'):
+				case ATEM_cmd('_','v','e','r'):
+				case ATEM_cmd('V','i','d','M'):
+				case ATEM_cmd('P','r','g','I'):
+				case ATEM_cmd('P','r','v','I'):
+				case ATEM_cmd('T','r','S','S'):
+				case ATEM_cmd('T','r','P','r'):
+				case ATEM_cmd('T','r','P','s'):
+				case ATEM_cmd('T','M','x','P'):
+				case ATEM_cmd('K','e','O','n'):
+				case ATEM_cmd('D','s','k','P'):
+				case ATEM_cmd('D','s','k','S'):
+				case ATEM_cmd('F','t','b','P'):
+				case ATEM_cmd('F','t','b','S'):
+				case ATEM_cmd('A','u','x','S'):
+				case ATEM_cmd('M','P','C','E'):
+				case ATEM_cmd('M','R','P','r'):
+				case ATEM_cmd('M','P','r','p'):
+				case ATEM_cmd('M','R','c','S'):
+				case ATEM_cmd('A','M','I','P'):
+				case ATEM_cmd('T','l','I','n'):
+					_readToPacketBuffer();	// Default
+					break;
+				default:
+					return;	// Not parsed here; _parsePacket() skips the whole segment in one go
+			}
+
+
+			switch (_cmdId)	{
+			case ATEM_cmd('_','p','i','n'):	{
 				if (_packetBuffer[5]=='T')	{
 						_ATEMmodel = 0;
 				} else
@@ -482,10 +518,10 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					}
 				}
 				#endif
-			}
+			}	break;
 
 			
-			if(!strcmp_P(cmdStr, PSTR("AMLv"))) {
+			case ATEM_cmd('A','M','L','v'):	{
 				sources = word(_packetBuffer[0],_packetBuffer[1]);
 				if (sources<=24) {
 						atemAudioMixerLevelsMasterLeft = (uint16_t)_packetBuffer[5]<<8 | _packetBuffer[6];
@@ -513,13 +549,13 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 							}
 						}
 				}
-			}
+			}	break;
 			
 
 
 
 			
-			if(!strcmp_P(cmdStr, PSTR("_ver"))) {
+			case ATEM_cmd('_','v','e','r'):	{
 				
 					#if ATEM_debug
 					temp = atemProtocolVersionMajor;
@@ -543,8 +579,8 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					}
 					#endif
 					
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("VidM"))) {
+			}	break;
+			case ATEM_cmd('V','i','d','M'):	{
 				
 					#if ATEM_debug
 					temp = atemVideoModeFormat;
@@ -557,15 +593,18 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					}
 					#endif
 					
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("PrgI"))) {
+			}	break;
+			case ATEM_cmd('P','r','g','I'):	{
 				
 				mE = _packetBuffer[0];
 				if (mE<=1) {
 					#if ATEM_debug
 					temp = atemProgramInputVideoSource[mE];
 					#endif
-					atemProgramInputVideoSource[mE] = word(_packetBuffer[2], _packetBuffer[3]);
+					if (atemProgramInputVideoSource[mE] != word(_packetBuffer[2], _packetBuffer[3]))	{
+						atemProgramInputVideoSource[mE] = word(_packetBuffer[2], _packetBuffer[3]);
+						atemInputVideoSourceGeneration++;
+					}
 					#if ATEM_debug
 					if ((_serialOutput==0x80 && atemProgramInputVideoSource[mE]!=temp) || (_serialOutput==0x81 && !hasInitialized()))	{
 						Serial.print(F("atemProgramInputVideoSource[mE=")); Serial.print(mE); Serial.print(F("] = "));
@@ -574,15 +613,18 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					#endif
 					
 				}
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("PrvI"))) {
+			}	break;
+			case ATEM_cmd('P','r','v','I'):	{
 				
 				mE = _packetBuffer[0];
 				if (mE<=1) {
 					#if ATEM_debug
 					temp = atemPreviewInputVideoSource[mE];
 					#endif
-					atemPreviewInputVideoSource[mE] = word(_packetBuffer[2], _packetBuffer[3]);
+					if (atemPreviewInputVideoSource[mE] != word(_packetBuffer[2], _packetBuffer[3]))	{
+						atemPreviewInputVideoSource[mE] = word(_packetBuffer[2], _packetBuffer[3]);
+						atemInputVideoSourceGeneration++;
+					}
 					#if ATEM_debug
 					if ((_serialOutput==0x80 && atemPreviewInputVideoSource[mE]!=temp) || (_serialOutput==0x81 && !hasInitialized()))	{
 						Serial.print(F("atemPreviewInputVideoSource[mE=")); Serial.print(mE); Serial.print(F("] = "));
@@ -591,8 +633,8 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					#endif
 					
 				}
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("TrSS"))) {
+			}	break;
+			case ATEM_cmd('T','r','S','S'):	{
 				
 				mE = _packetBuffer[0];
 				if (mE<=1) {
@@ -619,8 +661,8 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					#endif
 					
 				}
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("TrPr"))) {
+			}	break;
+			case ATEM_cmd('T','r','P','r'):	{
 				
 				mE = _packetBuffer[0];
 				if (mE<=1) {
@@ -636,8 +678,8 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					#endif
 					
 				}
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("TrPs"))) {
+			}	break;
+			case ATEM_cmd('T','r','P','s'):	{
 				
 				mE = _packetBuffer[0];
 				if (mE<=1) {
@@ -675,8 +717,8 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					#endif
 					
 				}
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("TMxP"))) {
+			}	break;
+			case ATEM_cmd('T','M','x','P'):	{
 				
 				mE = _packetBuffer[0];
 				if (mE<=1) {
@@ -692,8 +734,8 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					#endif
 					
 				}
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("KeOn"))) {
+			}	break;
+			case ATEM_cmd('K','e','O','n'):	{
 				
 				mE = _packetBuffer[0];
 				keyer = _packetBuffer[1];
@@ -710,8 +752,8 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					#endif
 					
 				}
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("DskP"))) {
+			}	break;
+			case ATEM_cmd('D','s','k','P'):	{
 				
 				keyer = _packetBuffer[0];
 				if (keyer<=1) {
@@ -837,8 +879,8 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					#endif
 					
 				}
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("DskS"))) {
+			}	break;
+			case ATEM_cmd('D','s','k','S'):	{
 				
 				keyer = _packetBuffer[0];
 				if (keyer<=1) {
@@ -887,8 +929,8 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					#endif
 					
 				}
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("FtbP"))) {
+			}	break;
+			case ATEM_cmd('F','t','b','P'):	{
 				
 				mE = _packetBuffer[0];
 				if (mE<=1) {
@@ -904,8 +946,8 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					#endif
 					
 				}
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("FtbS"))) {
+			}	break;
+			case ATEM_cmd('F','t','b','S'):	{
 				
 				mE = _packetBuffer[0];
 				if (mE<=1) {
@@ -943,8 +985,8 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					#endif
 					
 				}
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("AuxS"))) {
+			}	break;
+			case ATEM_cmd('A','u','x','S'):	{
 				
 				aUXChannel = _packetBuffer[0];
 				if (aUXChannel<=5) {
@@ -960,8 +1002,8 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					#endif
 					
 				}
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("MPCE"))) {
+			}	break;
+			case ATEM_cmd('M','P','C','E'):	{
 				
 				mediaPlayer = _packetBuffer[0];
 				if (mediaPlayer<=1) {
@@ -999,8 +1041,8 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					#endif
 					
 				}
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("MRPr"))) {
+			}	break;
+			case ATEM_cmd('M','R','P','r'):	{
 				
 					#if ATEM_debug
 					temp = atemMacroRunStatusState;
@@ -1035,8 +1077,8 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					}
 					#endif
 					
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("MPrp"))) {
+			}	break;
+			case ATEM_cmd('M','P','r','p'):	{
 				
 				macroIndex = _packetBuffer[1];
 				if (macroIndex<=9) {
@@ -1061,8 +1103,8 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					#endif	
 			
 				}
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("MRcS"))) {
+			}	break;
+			case ATEM_cmd('M','R','c','S'):	{
 				
 					#if ATEM_debug
 					temp = atemMacroRecordingStatusIsRecording;
@@ -1086,8 +1128,8 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					}
 					#endif
 					
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("AMIP"))) {
+			}	break;
+			case ATEM_cmd('A','M','I','P'):	{
 				
 				audioSource = word(_packetBuffer[0],_packetBuffer[1]);
 				if (getAudioSrcIndex(audioSource)<=24) {
@@ -1125,38 +1167,38 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 					#endif
 					
 				}
-			} else 
-			if(!strcmp_P(cmdStr, PSTR("TlIn"))) {
+			}	break;
+			case ATEM_cmd('T','l','I','n'):	{
 				
-				sources = word(_packetBuffer[0],_packetBuffer[1]);
-				if (sources<=20) {
-					#if ATEM_debug
-					temp = atemTallyByIndexSources;
-					#endif
-					atemTallyByIndexSources = word(_packetBuffer[0], _packetBuffer[1]);
-					#if ATEM_debug
-					if ((_serialOutput==0x80 && atemTallyByIndexSources!=temp) || (_serialOutput==0x81 && !hasInitialized()))	{
-						Serial.print(F("atemTallyByIndexSources = "));
-						Serial.println(atemTallyByIndexSources);
-					}
-					#endif
-
-					for(uint8_t a=0;a<sources;a++)	{
-						#if ATEM_debug
-						temp = atemTallyByIndexTallyFlags[a];
-						#endif
-						atemTallyByIndexTallyFlags[a] = _packetBuffer[2+a];
-						#if ATEM_debug
-						if ((_serialOutput==0x80 && atemTallyByIndexTallyFlags[a]!=temp) || (_serialOutput==0x81 && !hasInitialized()))	{
-							Serial.print(F("atemTallyByIndexTallyFlags[a=")); Serial.print(a); Serial.print(F("] = "));
-							Serial.println(atemTallyByIndexTallyFlags[a]);
-						}
-						#endif
+				#if ATEM_debug
+				temp = atemTallyByIndexSources;
+				#endif
+				atemTallyByIndexSources = _parseTallyByIndex(atemTallyByIndexTallyFlags, atemTallyByIndexChanged, ATEM_maxTallySources, &tallyChanged);
+				if (tallyChanged)	{
+					atemTallyByIndexGeneration++;
+				}
+				#if ATEM_debug
+				if ((_serialOutput==0x80 && atemTallyByIndexSources!=temp) || (_serialOutput==0x81 && !hasInitialized()))	{
+					Serial.print(F("atemTallyByIndexSources = "));
+					Serial.println(atemTallyByIndexSources);
+				}
+				if ((_serialOutput==0x80 && tallyChanged) || (_serialOutput==0x81 && !hasInitialized()))	{
+					for(uint8_t a=0;a<atemTallyByIndexSources && a<ATEM_maxTallySources;a++)	{
+						Serial.print(F("atemTallyByIndexTallyFlags[a=")); Serial.print(a); Serial.print(F("] = "));
+						Serial.println(atemTallyByIndexTallyFlags[a]);
 					}
+				}
+				#endif
 		
+			}	break;
+			case ATEM_cmd('T','l','S','r'):	{
+				
+				if (_parseTallyBySource(atemTallyBySourceTallyFlags))	{
+					atemTallyBySourceGeneration++;
 				}
-			} else 
-			{}
+		
+			}	break;
+			}
 		}
 
 
@@ -3484,6 +3526,7 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 			
 			/**
 			 * Get Tally By Index; Sources
+			 * As reported by the switcher, this may be more than ATEM_maxTallySources
 			 */
 			uint16_t ATEMstd::getTallyByIndexSources() {
 				return atemTallyByIndexSources;
@@ -3491,11 +3534,60 @@ long ATEMstd::getAudioMixerLevelsSourceRight() {
 			
 			/**
 			 * Get Tally By Index; Tally Flags
-			 * sources 	0-20: Number of
+			 * sources 	0-(ATEM_maxTallySources-1): Number of
 			 */
 			uint8_t ATEMstd::getTallyByIndexTallyFlags(uint16_t sources) {
 				return atemTallyByIndexTallyFlags[sources];
 			}
 			
+			/**
+			 * Get Tally By Index; Generation
+			 * Incremented each time a TlIn packet changes any of the tally flags, so callers can skip polling the flags until it moves.
+			 */
+			uint8_t ATEMstd::getTallyByIndexGeneration() {
+				return atemTallyByIndexGeneration;
+			}
+			
+			/**
+			 * Get Tally By Index; Changed
+			 * sources 	0-(ATEM_maxTallySources-1): True if the flags of this source changed since clearTallyByIndexChanged()
+			 */
+			bool ATEMstd::getTallyByIndexChanged(uint16_t sources) {
+				return atemTallyByIndexChanged[sources>>3] & (B1<<(sources&0x07));
+			}
+			
+			/**
+			 * Clear Tally By Index; Changed
+			 */
+			void ATEMstd::clearTallyByIndexChanged() {
+				memset(atemTallyByIndexChanged, 0, sizeof(atemTallyByIndexChanged));
+			}
+			
+			/**
+			 * Get Tally By Source; Tally Flags
+			 * videoSource 	(See video source list): Bit 0: Program, Bit 1: Preview. Covers every source in getVideoSrcIndex(), e.g. 6000 (Super Source), 3010 (Media Player 1) or 10010 (ME 1 Prog)
+			 */
+			uint8_t ATEMstd::getTallyBySourceTallyFlags(uint16_t videoSource) {
+				uint8_t srcIndex = getVideoSrcIndex(videoSource);
+				if (srcIndex==0 && videoSource!=0)	return 0;
+				return (atemTallyBySourceTallyFlags[srcIndex>>2] >> ((srcIndex&0x03)<<1)) & 0x03;
+			}
+			
+			/**
+			 * Get Program / Preview Input; Generation
+			 * Incremented each time a PrgI or PrvI packet changes the program or preview source of any M/E.
+			 */
+			uint8_t ATEMstd::getInputVideoSourceGeneration() {
+				return atemInputVideoSourceGeneration;
+			}
+			
+			/**
+			 * Get Tally By Source; Generation
+			 * Incremented each time a TlSr packet changes any of the tally flags.
+			 */
+			uint8_t ATEMstd::getTallyBySourceGeneration() {
+				return atemTallyBySourceGeneration;
+			}
+			
 
 	
\ No newline at end of file
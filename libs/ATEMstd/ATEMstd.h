@@ -221,7 +221,12 @@ private:
 			uint16_t atemAudioMixerInputVolume[25];
 			int16_t atemAudioMixerInputBalance[25];
 			uint16_t atemTallyByIndexSources;
-			uint8_t atemTallyByIndexTallyFlags[21];
+			uint8_t atemTallyByIndexTallyFlags[ATEM_maxTallySources];
+			uint8_t atemTallyByIndexChanged[(ATEM_maxTallySources+7)/8];	// Bit per source, set when its flags change
+			uint8_t atemTallyByIndexGeneration;
+			uint8_t atemTallyBySourceTallyFlags[(ATEM_tallyBySourceIndexes+3)/4];	// 2 bits per getVideoSrcIndex()
+			uint8_t atemTallyBySourceGeneration;
+			uint8_t atemInputVideoSourceGeneration;	// Program / preview source of any M/E changed
 
 public:
 			// Public Methods in ATEM.h:
@@ -367,6 +372,12 @@ public:
 			void setAudioLevelsEnable(bool enable);
 			uint16_t getTallyByIndexSources();
 			uint8_t getTallyByIndexTallyFlags(uint16_t sources);
+			uint8_t getTallyByIndexGeneration();
+			bool getTallyByIndexChanged(uint16_t sources);
+			void clearTallyByIndexChanged();
+			uint8_t getTallyBySourceTallyFlags(uint16_t videoSource);
+			uint8_t getTallyBySourceGeneration();
+			uint8_t getInputVideoSourceGeneration();
 };
 
 #endif
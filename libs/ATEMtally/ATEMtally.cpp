@@ -0,0 +1,229 @@
+/*
+Copyright 2012-2014 Kasper Skårhøj, SKAARHOJ K/S, kasper@skaarhoj.com
+
+This file is part of the Blackmagic Design ATEM Client library for Arduino
+
+The ATEM library is free software: you can redistribute it and/or modify 
+it under the terms of the GNU General Public License as published by the 
+Free Software Foundation, either version 3 of the License, or (at your 
+option) any later version.
+
+The ATEM library is distributed in the hope that it will be useful, but 
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY 
+or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along 
+with the ATEM library. If not, see http://www.gnu.org/licenses/.
+
+
+IMPORTANT: If you want to use this library in your own projects and/or products,
+please play a fair game and heed the license rules! See our web page for a Q&A so
+you can keep a clear conscience: http://skaarhoj.com/about/licenses/
+
+
+*/
+
+
+
+
+#include "ATEMtally.h"
+
+
+/**
+ * Constructor, call begin() before connecting
+ */
+ATEMtally::ATEMtally(){
+	atemProtocolVersionMajor = 0;
+	atemProtocolVersionMinor = 0;
+	memset(atemProgramInputVideoSource, 0, sizeof(atemProgramInputVideoSource));
+	memset(atemPreviewInputVideoSource, 0, sizeof(atemPreviewInputVideoSource));
+	atemTallyByIndexSources = 0;
+	memset(atemTallyByIndexTallyFlags, 0, sizeof(atemTallyByIndexTallyFlags));
+	memset(atemTallyByIndexChanged, 0, sizeof(atemTallyByIndexChanged));
+	atemTallyByIndexGeneration = 0;
+	memset(atemTallyBySourceTallyFlags, 0, sizeof(atemTallyBySourceTallyFlags));
+	atemTallyBySourceGeneration = 0;
+	atemInputVideoSourceGeneration = 0;
+}
+
+
+
+
+/********************************
+ *
+ * ATEM Switcher state methods
+ * Returns the most recent information we've 
+ * got about the switchers state
+ *
+ ********************************/
+
+
+
+/**
+ * Get ATEM state from the switcher: only the tally commands are read, with the TlIn/TlSr parsers ATEMstd uses too
+ */
+void ATEMtally::_parseGetCommands(const char *)	{
+	uint8_t mE;
+	bool tallyChanged = false;
+
+	switch (_cmdId)	{
+		case ATEM_cmd('T','l','S','r'):
+			_readToPacketBuffer(((ATEM_packetBufferLength-2)/3)*3+2);	// Sources count plus whole 3-byte entries
+			break;
+		case ATEM_cmd('_','p','i','n'):
+		case ATEM_cmd('_','v','e','r'):
+		case ATEM_cmd('P','r','g','I'):
+		case ATEM_cmd('P','r','v','I'):
+		case ATEM_cmd('T','l','I','n'):
+			_readToPacketBuffer();	// Default
+			break;
+		default:
+			return;	// Not parsed here; _parsePacket() skips the whole segment in one go
+	}
+
+	switch (_cmdId)	{
+	case ATEM_cmd('_','p','i','n'):	{
+		if (_packetBuffer[5]=='T')	{
+			_ATEMmodel = 0;
+		} else
+		if (_packetBuffer[5]=='1')	{
+			_ATEMmodel = _packetBuffer[29]=='4' ? 4 : 1;
+		} else
+		if (_packetBuffer[5]=='2')	{
+			_ATEMmodel = _packetBuffer[29]=='4' ? 5 : 2;
+		} else
+		if (_packetBuffer[5]=='P')	{
+			_ATEMmodel = 3;
+		}
+	}	break;
+	case ATEM_cmd('_','v','e','r'):	{
+		atemProtocolVersionMajor = word(_packetBuffer[0], _packetBuffer[1]);
+		atemProtocolVersionMinor = word(_packetBuffer[2], _packetBuffer[3]);
+	}	break;
+	case ATEM_cmd('P','r','g','I'):	{
+		mE = _packetBuffer[0];
+		if (mE<=1 && atemProgramInputVideoSource[mE] != word(_packetBuffer[2], _packetBuffer[3]))	{
+			atemProgramInputVideoSource[mE] = word(_packetBuffer[2], _packetBuffer[3]);
+			atemInputVideoSourceGeneration++;
+		}
+	}	break;
+	case ATEM_cmd('P','r','v','I'):	{
+		mE = _packetBuffer[0];
+		if (mE<=1 && atemPreviewInputVideoSource[mE] != word(_packetBuffer[2], _packetBuffer[3]))	{
+			atemPreviewInputVideoSource[mE] = word(_packetBuffer[2], _packetBuffer[3]);
+			atemInputVideoSourceGeneration++;
+		}
+	}	break;
+	case ATEM_cmd('T','l','I','n'):	{
+		atemTallyByIndexSources = _parseTallyByIndex(atemTallyByIndexTallyFlags, atemTallyByIndexChanged, ATEM_maxTallySources, &tallyChanged);
+		if (tallyChanged)	{
+			atemTallyByIndexGeneration++;
+		}
+	}	break;
+	case ATEM_cmd('T','l','S','r'):	{
+		if (_parseTallyBySource(atemTallyBySourceTallyFlags))	{
+			atemTallyBySourceGeneration++;
+		}
+	}	break;
+	}
+}
+
+
+
+
+
+/**
+ * Get Protocol Version; Major
+ */
+uint16_t ATEMtally::getProtocolVersionMajor() {
+	return atemProtocolVersionMajor;
+}
+
+/**
+ * Get Protocol Version; Minor
+ */
+uint16_t ATEMtally::getProtocolVersionMinor() {
+	return atemProtocolVersionMinor;
+}
+
+/**
+ * Get Program Input; Video Source
+ * mE 	0: ME1, 1: ME2
+ */
+uint16_t ATEMtally::getProgramInputVideoSource(uint8_t mE) {
+	return atemProgramInputVideoSource[mE];
+}
+
+/**
+ * Get Preview Input; Video Source
+ * mE 	0: ME1, 1: ME2
+ */
+uint16_t ATEMtally::getPreviewInputVideoSource(uint8_t mE) {
+	return atemPreviewInputVideoSource[mE];
+}
+
+/**
+ * Get Tally By Index; Sources
+ * As reported by the switcher, this may be more than ATEM_maxTallySources
+ */
+uint16_t ATEMtally::getTallyByIndexSources() {
+	return atemTallyByIndexSources;
+}
+
+/**
+ * Get Tally By Index; Tally Flags
+ * sources 	0-(ATEM_maxTallySources-1): Number of
+ */
+uint8_t ATEMtally::getTallyByIndexTallyFlags(uint16_t sources) {
+	return atemTallyByIndexTallyFlags[sources];
+}
+
+/**
+ * Get Tally By Index; Generation
+ * Incremented each time a TlIn packet changes any of the tally flags, so callers can skip polling the flags until it moves.
+ */
+uint8_t ATEMtally::getTallyByIndexGeneration() {
+	return atemTallyByIndexGeneration;
+}
+
+/**
+ * Get Tally By Index; Changed
+ * sources 	0-(ATEM_maxTallySources-1): True if the flags of this source changed since clearTallyByIndexChanged()
+ */
+bool ATEMtally::getTallyByIndexChanged(uint16_t sources) {
+	return atemTallyByIndexChanged[sources>>3] & (B1<<(sources&0x07));
+}
+
+/**
+ * Clear Tally By Index; Changed
+ */
+void ATEMtally::clearTallyByIndexChanged() {
+	memset(atemTallyByIndexChanged, 0, sizeof(atemTallyByIndexChanged));
+}
+
+/**
+ * Get Tally By Source; Tally Flags
+ * videoSource 	(See video source list): Bit 0: Program, Bit 1: Preview. Covers every source in getVideoSrcIndex()
+ */
+uint8_t ATEMtally::getTallyBySourceTallyFlags(uint16_t videoSource) {
+	uint8_t srcIndex = getVideoSrcIndex(videoSource);
+	if (srcIndex==0 && videoSource!=0)	return 0;
+	return (atemTallyBySourceTallyFlags[srcIndex>>2] >> ((srcIndex&0x03)<<1)) & 0x03;
+}
+
+/**
+ * Get Tally By Source; Generation
+ * Incremented each time a TlSr packet changes any of the tally flags.
+ */
+uint8_t ATEMtally::getTallyBySourceGeneration() {
+	return atemTallyBySourceGeneration;
+}
+
+/**
+ * Get Program / Preview Input; Generation
+ * Incremented each time a PrgI or PrvI packet changes the program or preview source of any M/E.
+ */
+uint8_t ATEMtally::getInputVideoSourceGeneration() {
+	return atemInputVideoSourceGeneration;
+}
@@ -0,0 +1,77 @@
+/*
+Copyright 2012-2014 Kasper Skårhøj, SKAARHOJ K/S, kasper@skaarhoj.com
+
+This file is part of the Blackmagic Design ATEM Client library for Arduino
+
+The ATEM library is free software: you can redistribute it and/or modify 
+it under the terms of the GNU General Public License as published by the 
+Free Software Foundation, either version 3 of the License, or (at your 
+option) any later version.
+
+The ATEM library is distributed in the hope that it will be useful, but 
+WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY 
+or FITNESS FOR A PARTICULAR PURPOSE. 
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along 
+with the ATEM library. If not, see http://www.gnu.org/licenses/.
+
+
+IMPORTANT: If you want to use this library in your own projects and/or products,
+please play a fair game and heed the license rules! See our web page for a Q&A so
+you can keep a clear conscience: http://skaarhoj.com/about/licenses/
+
+
+*/
+
+
+
+
+#ifndef ATEMtally_h
+#define ATEMtally_h
+
+#include "ATEMbase.h"
+
+
+
+
+/**
+ * Tally-only ATEM client: the same tally getters as ATEMstd, but only _ver, _pin, PrgI, PrvI, TlIn and TlSr are parsed
+ * and kept. Every other command is skipped by _parsePacket() without being read, and none of ATEMstd's keyer, audio,
+ * macro or media state is allocated.
+ */
+class ATEMtally : public ATEMbase
+{
+  public:
+	ATEMtally();
+
+	uint16_t getProtocolVersionMajor();
+	uint16_t getProtocolVersionMinor();
+	uint16_t getProgramInputVideoSource(uint8_t mE);
+	uint16_t getPreviewInputVideoSource(uint8_t mE);
+	uint16_t getTallyByIndexSources();
+	uint8_t getTallyByIndexTallyFlags(uint16_t sources);
+	uint8_t getTallyByIndexGeneration();
+	bool getTallyByIndexChanged(uint16_t sources);
+	void clearTallyByIndexChanged();
+	uint8_t getTallyBySourceTallyFlags(uint16_t videoSource);
+	uint8_t getTallyBySourceGeneration();
+	uint8_t getInputVideoSourceGeneration();
+
+  private:
+	void _parseGetCommands(const char *);
+
+	uint16_t atemProtocolVersionMajor;
+	uint16_t atemProtocolVersionMinor;
+	uint16_t atemProgramInputVideoSource[2];
+	uint16_t atemPreviewInputVideoSource[2];
+	uint16_t atemTallyByIndexSources;
+	uint8_t atemTallyByIndexTallyFlags[ATEM_maxTallySources];
+	uint8_t atemTallyByIndexChanged[(ATEM_maxTallySources+7)/8];	// Bit per source, set when its flags change
+	uint8_t atemTallyByIndexGeneration;
+	uint8_t atemTallyBySourceTallyFlags[(ATEM_tallyBySourceIndexes+3)/4];	// 2 bits per getVideoSrcIndex()
+	uint8_t atemTallyBySourceGeneration;
+	uint8_t atemInputVideoSourceGeneration;	// Program / preview source of any M/E changed
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "TallyFec.h"
+
+// extended Hamming(8,4): bits 0-6 are Hamming(7,4) (p1 p2 d1 p3 d2 d3 d4),
+// bit 7 the parity of the other seven
+static const uint8_t kEncode[16] PROGMEM = {
+    0x00, 0x87, 0x99, 0x1E, 0xAA, 0x2D, 0x33, 0xB4,
+    0x4B, 0xCC, 0xD2, 0x55, 0xE1, 0x66, 0x78, 0xFF,
+};
+
+// nearest codeword for every byte: the nibble, | TALLY_FEC_UNCORRECTABLE
+// if two codewords are as near
+static const uint8_t kDecode[256] PROGMEM = {
+    0x00, 0x00, 0x00, 0x10, 0x00, 0x10, 0x10, 0x01,
+    0x00, 0x10, 0x10, 0x08, 0x10, 0x05, 0x03, 0x11,
+    0x00, 0x10, 0x10, 0x06, 0x10, 0x0B, 0x03, 0x11,
+    0x10, 0x02, 0x03, 0x12, 0x03, 0x12, 0x03, 0x03,
+    0x00, 0x10, 0x10, 0x06, 0x10, 0x05, 0x0D, 0x11,
+    0x10, 0x05, 0x04, 0x14, 0x05, 0x05, 0x13, 0x05,
+    0x10, 0x06, 0x06, 0x06, 0x07, 0x15, 0x13, 0x06,
+    0x0E, 0x12, 0x13, 0x06, 0x13, 0x05, 0x03, 0x13,
+    0x00, 0x10, 0x10, 0x08, 0x10, 0x0B, 0x0D, 0x11,
+    0x10, 0x08, 0x08, 0x08, 0x09, 0x15, 0x13, 0x08,
+    0x10, 0x0B, 0x0A, 0x16, 0x0B, 0x0B, 0x13, 0x0B,
+    0x0E, 0x12, 0x13, 0x08, 0x13, 0x0B, 0x03, 0x13,
+    0x10, 0x0C, 0x0D, 0x16, 0x0D, 0x15, 0x0D, 0x0D,
+    0x0E, 0x15, 0x14, 0x08, 0x15, 0x05, 0x0D, 0x15,
+    0x0E, 0x16, 0x16, 0x06, 0x17, 0x0B, 0x0D, 0x16,
+    0x0E, 0x0E, 0x0E, 0x16, 0x0E, 0x15, 0x13, 0x0F,
+    0x00, 0x10, 0x10, 0x01, 0x10, 0x01, 0x01, 0x01,
+    0x10, 0x02, 0x04, 0x11, 0x09, 0x11, 0x11, 0x01,
+    0x10, 0x02, 0x0A, 0x11, 0x07, 0x11, 0x11, 0x01,
+    0x02, 0x02, 0x12, 0x02, 0x12, 0x02, 0x03, 0x11,
+    0x10, 0x0C, 0x04, 0x11, 0x07, 0x11, 0x11, 0x01,
+    0x04, 0x12, 0x04, 0x04, 0x14, 0x05, 0x04, 0x11,
+    0x07, 0x12, 0x14, 0x06, 0x07, 0x07, 0x07, 0x11,
+    0x12, 0x02, 0x04, 0x12, 0x07, 0x12, 0x13, 0x0F,
+    0x10, 0x0C, 0x0A, 0x11, 0x09, 0x11, 0x11, 0x01,
+    0x09, 0x12, 0x14, 0x08, 0x09, 0x09, 0x09, 0x11,
+    0x0A, 0x12, 0x0A, 0x0A, 0x17, 0x0B, 0x0A, 0x11,
+    0x12, 0x02, 0x0A, 0x12, 0x09, 0x12, 0x13, 0x0F,
+    0x0C, 0x0C, 0x14, 0x0C, 0x17, 0x0C, 0x0D, 0x11,
+    0x14, 0x0C, 0x04, 0x14, 0x09, 0x15, 0x14, 0x0F,
+    0x17, 0x0C, 0x0A, 0x16, 0x07, 0x17, 0x17, 0x0F,
+    0x0E, 0x12, 0x14, 0x0F, 0x17, 0x0F, 0x0F, 0x0F,
+};
+
+void TallyFecEncode(uint8_t byte, uint8_t* pair) {
+  pair[0] = pgm_read_byte(&kEncode[byte & 0x0F]);
+  pair[1] = pgm_read_byte(&kEncode[byte >> 4]);
+}
+
+uint8_t TallyFecDecodeNibble(uint8_t codeword) {
+  return pgm_read_byte(&kDecode[codeword]);
+}
+
+uint8_t TallyFrameWrite(Print* port, const uint8_t* frame, uint8_t length) {
+#if TALLY_FRAME_FEC
+  for (uint8_t i = 0; i < length; i++) {
+    uint8_t pair[2];
+    TallyFecEncode(frame[i], pair);
+    port->write(pair, 2);
+  }
+#else
+  port->write(frame, length);
+#endif
+  return TALLY_FEC_LENGTH(length);
+}
+
+bool TallyFecDecoder::Push(uint8_t c) {
+  // c ends a pair for one alignment, the other gets its pair next time
+  uint8_t phase = _next;
+  uint8_t first = _previous;
+  _next ^= 1;
+  _previous = c;
+
+  uint8_t low = TallyFecDecodeNibble(first);
+  uint8_t high = TallyFecDecodeNibble(c);
+  // an uncorrectable nibble goes in as its best guess, the CRC decides
+  if (!_phase[phase].Push((low & 0x0F) | ((high & 0x0F) << 4))) {
+    return false;
+  }
+  _last = phase;
+  return true;
+}
@@ -0,0 +1,75 @@
+/**
+ * Optional forward error correction for the RF link (TALLY_FRAME_FEC).
+ *
+ * Every byte of a frame goes on air as two extended Hamming(8,4) codewords,
+ * low nibble first: one bit error per codeword is corrected, two are
+ * detected. That doubles the airtime (a keyframe of 8 cameras takes 14
+ * bytes) but a receiver at the edge of the range keeps its light right
+ * without waiting for a repeat. The CRC-8 of the frame still rejects what
+ * the code could not correct.
+ *
+ * The receiver does not know where a codeword pair starts, so
+ * TallyFecDecoder decodes the stream at both byte alignments and takes the
+ * frames of whichever one passes the CRC.
+ */
+#ifndef TallyFec_h
+#define TallyFec_h
+
+#include <Arduino.h>
+
+#include "TallyFrame.h"
+
+// bytes on air for a frame of the given length
+#define TALLY_FEC_LENGTH(length) (TALLY_FRAME_FEC ? 2 * (length) : (length))
+// TallyFecDecodeNibble(): the codeword had more than one bit error
+#define TALLY_FEC_UNCORRECTABLE 0x10
+
+// writes the two codewords of byte to pair
+void TallyFecEncode(uint8_t byte, uint8_t* pair);
+
+// @return the nibble of a codeword, or'ed with TALLY_FEC_UNCORRECTABLE
+uint8_t TallyFecDecodeNibble(uint8_t codeword);
+
+/**
+ * @brief writes a frame to the radio, FEC coded if TALLY_FRAME_FEC
+ *
+ * @return bytes on air
+ */
+uint8_t TallyFrameWrite(Print* port, const uint8_t* frame, uint8_t length);
+
+/**
+ * @brief TallyFrameDecoder for an FEC coded stream, same interface
+ */
+class TallyFecDecoder {
+ private:
+  TallyFrameDecoder _phase[2];
+  uint8_t _previous = 0;
+  uint8_t _next = 0;  // phase the next byte completes a pair of
+  uint8_t _last = 0;  // phase of the last frame
+
+ public:
+  bool Push(uint8_t c);
+
+  uint8_t Type() const { return _phase[_last].Type(); }
+  uint8_t Group() const { return _phase[_last].Group(); }
+  uint8_t Sequence() const { return _phase[_last].Sequence(); }
+  uint8_t Count() const { return _phase[_last].Count(); }
+  const uint8_t* Frame() const { return _phase[_last].Frame(); }
+  uint8_t Length() const { return _phase[_last].Length(); }
+  void Apply(uint8_t* states, uint8_t cameras) const {
+    _phase[_last].Apply(states, cameras);
+  }
+  bool Ack(TallyFrameAck* ack) const { return _phase[_last].Ack(ack); }
+
+  // frames dropped at the alignment of the last frame
+  uint16_t Errors() const { return _phase[_last].Errors(); }
+};
+
+// the decoder for what is on air
+#if TALLY_FRAME_FEC
+typedef TallyFecDecoder TallyLinkDecoder;
+#else
+typedef TallyFrameDecoder TallyLinkDecoder;
+#endif
+
+#endif
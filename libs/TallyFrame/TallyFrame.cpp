@@ -0,0 +1,165 @@
+#include "TallyFrame.h"
+
+static uint8_t Header(uint8_t type, uint8_t group) {
+  return (TALLY_FRAME_VERSION << 5) | (type << 3) | (group & 0x07);
+}
+
+// frame length for a header, sequence and count already received
+static uint8_t FrameLength(uint8_t header, uint8_t count) {
+  if ((header >> 5) != TALLY_FRAME_VERSION) {
+    return 0;
+  }
+  switch ((header >> 3) & 0x03) {
+    case TALLY_FRAME_KEY:
+      return TALLY_FRAME_HEADER_LENGTH + TALLY_FRAME_STATE_BYTES(count) + 1;
+    case TALLY_FRAME_DELTA:
+      return count <= TALLY_FRAME_DELTA_CAMERAS
+                 ? TALLY_FRAME_HEADER_LENGTH + count + 1
+                 : 0;
+    case TALLY_FRAME_ACK:
+      return TALLY_FRAME_ACK_LENGTH;
+    default:
+      return 0;
+  }
+}
+
+uint8_t TallyFrameCrc8(const uint8_t* data, uint8_t length) {
+  uint8_t crc = 0;
+  while (length--) {
+    crc ^= *data++;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+uint8_t TallyFrameEncodeKey(uint8_t* frame, uint8_t group, uint8_t sequence,
+                            const uint8_t* states, uint8_t cameras) {
+  uint8_t bytes = TALLY_FRAME_STATE_BYTES(cameras);
+  frame[0] = TALLY_FRAME_SYNC;
+  frame[1] = Header(TALLY_FRAME_KEY, group);
+  frame[2] = sequence;
+  frame[3] = cameras;
+  memcpy(frame + TALLY_FRAME_HEADER_LENGTH, states, bytes);
+  // unused bits of the last byte go out as 0 whatever the caller had there
+  if (cameras % 4) {
+    uint8_t used = (1 << 2 * (cameras % 4)) - 1;
+    frame[TALLY_FRAME_HEADER_LENGTH + bytes - 1] &= used;
+  }
+  uint8_t length = TALLY_FRAME_HEADER_LENGTH + bytes;
+  frame[length] = TallyFrameCrc8(frame + 1, length - 1);
+  return length + 1;
+}
+
+uint8_t TallyFrameEncodeDelta(uint8_t* frame, uint8_t group,
+                              uint8_t sequence, const uint8_t* states,
+                              const uint8_t* previous, uint8_t cameras) {
+  uint8_t key_bytes = TALLY_FRAME_STATE_BYTES(cameras);
+  uint8_t* entry = frame + TALLY_FRAME_HEADER_LENGTH;
+  uint8_t entries = 0;
+  for (uint8_t camera = 0; camera < cameras; camera++) {
+    uint8_t state = TallyFrameGetState(states, camera);
+    if (state == TallyFrameGetState(previous, camera)) {
+      continue;
+    }
+    if (camera >= TALLY_FRAME_DELTA_CAMERAS || entries == key_bytes) {
+      return 0;
+    }
+    entry[entries++] = (camera << 2) | state;
+  }
+  // same length as the keyframe: send the keyframe, it also repairs losses
+  if (entries && entries >= key_bytes) {
+    return 0;
+  }
+  uint8_t length = TALLY_FRAME_HEADER_LENGTH + entries;
+  frame[0] = TALLY_FRAME_SYNC;
+  frame[1] = Header(TALLY_FRAME_DELTA, group);
+  frame[2] = sequence;
+  frame[3] = entries;
+  frame[length] = TallyFrameCrc8(frame + 1, length - 1);
+  return length + 1;
+}
+
+// a rejected frame may have started on a stray SYNC byte (RF noise, a
+// truncated frame): the next SYNC already received starts the next candidate
+void TallyFrameDecoder::Drop(uint8_t count) {
+  while (count < _length && _frame[count] != TALLY_FRAME_SYNC) {
+    count++;
+  }
+  _length -= count;
+  memmove(_frame, _frame + count, _length);
+}
+
+uint8_t TallyFrameEncodeAck(uint8_t* frame, const TallyFrameAck& ack) {
+  frame[0] = TALLY_FRAME_SYNC;
+  frame[1] = Header(TALLY_FRAME_ACK, ack.group);
+  frame[2] = ack.sequence;
+  frame[3] = ack.receiver;
+  frame[4] = ack.flags;
+  frame[5] = ack.lost;
+  frame[6] = ack.errors;
+  frame[7] = ack.rssi;
+  frame[8] = TallyFrameCrc8(frame + 1, TALLY_FRAME_ACK_LENGTH - 2);
+  return TALLY_FRAME_ACK_LENGTH;
+}
+
+bool TallyFrameDecoder::Push(uint8_t c) {
+  if (_complete) {
+    _complete = false;
+    Drop(_expected);
+  }
+  if (_length == 0 && c != TALLY_FRAME_SYNC) {
+    return false;
+  }
+  _frame[_length++] = c;
+  while (_length >= TALLY_FRAME_HEADER_LENGTH) {
+    _expected = FrameLength(_frame[1], _frame[3]);
+    if (_expected && _length < _expected) {
+      return false;
+    }
+    if (_expected &&
+        TallyFrameCrc8(_frame + 1, _expected - 2) == _frame[_expected - 1]) {
+      _complete = true;
+      return true;
+    }
+    _errors++;
+    Drop(1);
+  }
+  return false;
+}
+
+void TallyFrameDecoder::Apply(uint8_t* states, uint8_t cameras) const {
+  const uint8_t* payload = _frame + TALLY_FRAME_HEADER_LENGTH;
+  if (Type() == TALLY_FRAME_ACK) {
+    return;
+  }
+  if (Type() == TALLY_FRAME_KEY) {
+    for (uint8_t camera = 0; camera < cameras; camera++) {
+      TallyFrameSetState(states, camera,
+                         camera < Count() ? TallyFrameGetState(payload, camera)
+                                          : TALLY_FRAME_OFF);
+    }
+    return;
+  }
+  for (uint8_t i = 0; i < Count(); i++) {
+    uint8_t camera = payload[i] >> 2;
+    if (camera < cameras) {
+      TallyFrameSetState(states, camera, payload[i] & 0x03);
+    }
+  }
+}
+
+bool TallyFrameDecoder::Ack(TallyFrameAck* ack) const {
+  if (Type() != TALLY_FRAME_ACK) {
+    return false;
+  }
+  ack->receiver = _frame[3];
+  ack->group = Group();
+  ack->sequence = _frame[2];
+  ack->flags = _frame[4];
+  ack->lost = _frame[5];
+  ack->errors = _frame[6];
+  ack->rssi = _frame[7];
+  return true;
+}
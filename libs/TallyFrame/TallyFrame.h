@@ -0,0 +1,168 @@
+/**
+ * Binary tally frame sent from the transmitter to the receivers over RF.
+ *
+ *   SYNC  HEADER  SEQUENCE  COUNT  PAYLOAD...  CRC
+ *
+ * SYNC     TALLY_FRAME_SYNC, where a receiver starts looking for a frame
+ * HEADER   bits 7-5 version, bits 4-3 frame type, bits 2-0 tally group
+ * SEQUENCE incremented by the transmitter for every frame of the group
+ * COUNT    keyframe: number of cameras, delta: number of entries,
+ *          ack: receiver id
+ * PAYLOAD  keyframe: 2 bits per camera, camera n in byte n / 4 at bit
+ *          2 * (n % 4); delta: one byte per changed camera, camera << 2 |
+ *          state (cameras 0-63 only); ack: see TallyFrameAck
+ * CRC      CRC-8 (polynomial 0x07) of HEADER to the end of PAYLOAD
+ *
+ * A camera state is TALLY_FRAME_OFF, TALLY_FRAME_PREVIEW or
+ * TALLY_FRAME_PROGRAM. 8 cameras take 7 bytes in a keyframe and 6 in a delta
+ * with one change, against 12 for the old "1xxxxxxxx;\r\n" text frame.
+ *
+ * Acks go the other way, from receivers that were told to send them.
+ * Receiver n acks every delta of its group, the keyframes whose sequence
+ * number is n modulo TALLY_FRAME_ACK_SLOTS, and any keyframe that follows a
+ * frame it missed. It answers in its own slot,
+ * (n % TALLY_FRAME_ACK_SLOTS + 1) * TALLY_FRAME_ACK_SLOT_MS after the last
+ * frame it heard, so up to TALLY_FRAME_ACK_SLOTS receivers do not collide
+ * and nobody acks in the middle of a burst of frames. A keyframe carries
+ * all earlier frames, so it replaces the acks they left pending. Nobody
+ * starts to send less than TALLY_FRAME_QUIET_MS after the last byte they
+ * heard.
+ */
+#ifndef TallyFrame_h
+#define TallyFrame_h
+
+#include <Arduino.h>
+
+#define TALLY_FRAME_SYNC 0xA5
+#define TALLY_FRAME_VERSION 1
+
+#define TALLY_FRAME_KEY 0
+#define TALLY_FRAME_DELTA 1
+#define TALLY_FRAME_ACK 2
+
+#define TALLY_FRAME_OFF 0
+#define TALLY_FRAME_PREVIEW 1
+#define TALLY_FRAME_PROGRAM 2
+
+#define TALLY_FRAME_GROUPS 8
+#define TALLY_FRAME_MAX_CAMERAS 255
+#define TALLY_FRAME_DELTA_CAMERAS 64
+// bytes of a 2 bit per camera state array
+#define TALLY_FRAME_STATE_BYTES(cameras) (((cameras) + 3) / 4)
+#define TALLY_FRAME_HEADER_LENGTH 4
+#define TALLY_FRAME_ACK_LENGTH (TALLY_FRAME_HEADER_LENGTH + 4 + 1)
+#define TALLY_FRAME_MAX_LENGTH                 \
+  (TALLY_FRAME_HEADER_LENGTH +                 \
+   TALLY_FRAME_STATE_BYTES(TALLY_FRAME_MAX_CAMERAS) + 1)
+
+inline uint8_t TallyFrameGetState(const uint8_t* states, uint8_t camera) {
+  return (states[camera / 4] >> (2 * (camera % 4))) & 0x03;
+}
+
+inline void TallyFrameSetState(uint8_t* states, uint8_t camera,
+                               uint8_t state) {
+  uint8_t shift = 2 * (camera % 4);
+  states[camera / 4] =
+      (states[camera / 4] & ~(0x03 << shift)) | ((state & 0x03) << shift);
+}
+
+// every byte on air as two Hamming codes, see TallyFec.h; transmitter and
+// receivers must agree
+#ifndef TALLY_FRAME_FEC
+#define TALLY_FRAME_FEC 0
+#endif
+
+// an ack frame gets 9 bytes at 9600 baud, 9.4 ms (18.8 ms with FEC)
+#define TALLY_FRAME_ACK_SLOT_MS (TALLY_FRAME_FEC ? 21 : 12)
+#define TALLY_FRAME_ACK_SLOTS 8
+#define TALLY_FRAME_QUIET_MS 2
+// the receiver has every frame since a keyframe of its group
+#define TALLY_FRAME_ACK_IN_SYNC 0x01
+
+/**
+ * @brief what a receiver reports back, see TallyFrameEncodeAck()
+ */
+struct TallyFrameAck {
+  uint8_t receiver;
+  uint8_t group;
+  uint8_t sequence;  // last frame of the group it received
+  uint8_t flags;     // TALLY_FRAME_ACK_IN_SYNC
+  uint8_t lost;      // frames of the group it missed, wraps at 256
+  uint8_t errors;    // frames its decoder dropped, wraps at 256
+  uint8_t rssi;      // signal strength if the radio reports one, else 0
+};
+
+uint8_t TallyFrameCrc8(const uint8_t* data, uint8_t length);
+
+/**
+ * @brief writes a keyframe with the state of all cameras
+ *
+ * @param frame at least TALLY_FRAME_MAX_LENGTH bytes
+ * @param states 2 bits per camera, see TallyFrameSetState()
+ * @return frame length
+ */
+uint8_t TallyFrameEncodeKey(uint8_t* frame, uint8_t group, uint8_t sequence,
+                            const uint8_t* states, uint8_t cameras);
+
+/**
+ * @brief writes a delta frame with the cameras whose state differs between
+ *  previous and states
+ *
+ * @return frame length, 0 if a keyframe is needed instead: a changed camera
+ *  is above TALLY_FRAME_DELTA_CAMERAS or the delta would not be shorter
+ */
+uint8_t TallyFrameEncodeDelta(uint8_t* frame, uint8_t group,
+                              uint8_t sequence, const uint8_t* states,
+                              const uint8_t* previous, uint8_t cameras);
+
+/**
+ * @return frame length, TALLY_FRAME_ACK_LENGTH
+ */
+uint8_t TallyFrameEncodeAck(uint8_t* frame, const TallyFrameAck& ack);
+
+/**
+ * @brief receiver side: finds frames in the byte stream and checks them
+ *
+ * Bytes are pushed as they come off the RF serial port. A frame with a bad
+ * CRC, an unknown version or type, or an impossible length is dropped and
+ * the decoder starts over at the next SYNC byte it already holds.
+ */
+class TallyFrameDecoder {
+ private:
+  uint8_t _frame[TALLY_FRAME_MAX_LENGTH];
+  uint8_t _length = 0;
+  uint8_t _expected = 0;
+  uint16_t _errors = 0;
+  bool _complete = false;
+
+  void Drop(uint8_t count);
+
+ public:
+  /**
+   * @return true once c completes a valid frame; the accessors below stay
+   *  valid until the next call
+   */
+  bool Push(uint8_t c);
+
+  uint8_t Type() const { return (_frame[1] >> 3) & 0x03; }
+  uint8_t Group() const { return _frame[1] & 0x07; }
+  uint8_t Sequence() const { return _frame[2]; }
+  uint8_t Count() const { return _frame[3]; }
+  const uint8_t* Frame() const { return _frame; }
+  uint8_t Length() const { return _expected; }
+
+  /**
+   * @brief applies the frame to a receiver's state array: a keyframe
+   *  replaces it (cameras the frame does not cover go off), a delta only
+   *  changes the cameras it lists, an ack does nothing
+   */
+  void Apply(uint8_t* states, uint8_t cameras) const;
+
+  // @return false if the frame is not an ack
+  bool Ack(TallyFrameAck* ack) const;
+
+  // frames dropped for a bad CRC, version or length since power up
+  uint16_t Errors() const { return _errors; }
+};
+
+#endif
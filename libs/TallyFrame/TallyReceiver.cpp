@@ -0,0 +1,76 @@
+#include "TallyReceiver.h"
+
+TallyReceiver::TallyReceiver(Stream* port, uint8_t id, uint8_t group)
+    : _port(port), _id(id), _group(group) {}
+
+uint8_t TallyReceiver::State(uint8_t camera) const {
+  return camera < TALLY_RECEIVER_CAMERAS ? TallyFrameGetState(_states, camera)
+                                         : TALLY_FRAME_OFF;
+}
+
+// a frame of our group was decoded
+void TallyReceiver::Receive(unsigned long now) {
+  uint8_t sequence = _decoder.Sequence();
+  // a gap in the sequence numbers is a frame we missed
+  bool gap = _seen && sequence != (uint8_t)(_sequence + 1);
+  bool behind = gap || !_in_sync;
+  if (gap) {
+    _lost += (uint8_t)(sequence - _sequence - 1);
+    _in_sync = false;
+  }
+  if (_decoder.Type() == TALLY_FRAME_KEY) {
+    _in_sync = true;
+  }
+  _seen = true;
+  _sequence = sequence;
+  _received_at = now;
+  _decoder.Apply(_states, TALLY_RECEIVER_CAMERAS);
+
+  if (!_use_acks) {
+    return;
+  }
+  // a keyframe has it all, earlier frames in the burst need no ack of
+  // their own
+  if (_decoder.Type() == TALLY_FRAME_KEY) {
+    _ack_pending = false;
+  }
+  if (_decoder.Type() == TALLY_FRAME_DELTA || behind ||
+      sequence % TALLY_FRAME_ACK_SLOTS == _id % TALLY_FRAME_ACK_SLOTS) {
+    _ack_pending = true;
+  }
+}
+
+bool TallyReceiver::Poll() {
+  unsigned long now = millis();
+  bool updated = false;
+  while (_port->available()) {
+    _heard_at = now;
+    if (!_decoder.Push(_port->read()) ||
+        _decoder.Type() == TALLY_FRAME_ACK) {
+      continue;
+    }
+    // any frame starts the slots over: one ack for all frames received
+    // before our slot comes up
+    _ack_at = now + (_id % TALLY_FRAME_ACK_SLOTS + 1) * TALLY_FRAME_ACK_SLOT_MS;
+    if (_decoder.Group() == _group) {
+      Receive(now);
+      updated = true;
+    }
+  }
+
+  if (_ack_pending && (long)(now - _ack_at) >= 0 &&
+      now - _heard_at >= TALLY_FRAME_QUIET_MS) {
+    _ack_pending = false;
+    TallyFrameAck ack;
+    ack.receiver = _id;
+    ack.group = _group;
+    ack.sequence = _sequence;
+    ack.flags = _in_sync ? TALLY_FRAME_ACK_IN_SYNC : 0;
+    ack.lost = _lost;
+    ack.errors = _decoder.Errors();
+    ack.rssi = _rssi;
+    uint8_t frame[TALLY_FRAME_ACK_LENGTH];
+    TallyFrameWrite(_port, frame, TallyFrameEncodeAck(frame, ack));
+  }
+  return updated;
+}
@@ -0,0 +1,68 @@
+/**
+ * Receiver side of the RF link: decodes the frames of one tally group from
+ * the radio and, if asked to, acks them back to the transmitter in its own
+ * slot (see TallyFrame.h).
+ */
+#ifndef TallyReceiver_h
+#define TallyReceiver_h
+
+#include <Arduino.h>
+
+#include "TallyFec.h"
+#include "TallyFrame.h"
+
+// cameras a receiver keeps the state of, override with -D
+#ifndef TALLY_RECEIVER_CAMERAS
+#define TALLY_RECEIVER_CAMERAS 64
+#endif
+
+class TallyReceiver {
+ private:
+  Stream* _port;
+  uint8_t _id;
+  uint8_t _group;
+  TallyLinkDecoder _decoder;
+  uint8_t _states[TALLY_FRAME_STATE_BYTES(TALLY_RECEIVER_CAMERAS)] = {0};
+  unsigned long _received_at = 0;
+  unsigned long _heard_at = 0;
+
+  bool _use_acks = false;
+  bool _seen = false;
+  bool _in_sync = false;
+  uint8_t _sequence = 0;
+  uint8_t _lost = 0;
+  uint8_t _rssi = 0;
+  bool _ack_pending = false;
+  unsigned long _ack_at = 0;
+
+  void Receive(unsigned long now);
+
+ public:
+  /**
+   * @param id unique per receiver, also picks its ack slot
+   * @param group tally group whose frames it shows (and acks)
+   */
+  TallyReceiver(Stream* port, uint8_t id, uint8_t group);
+
+  void UseAcks(bool enabled) { _use_acks = enabled; }
+  // reported in the next acks, for radios that measure it
+  void SetRssi(uint8_t rssi) { _rssi = rssi; }
+
+  /**
+   * @brief reads what the radio received and sends a pending ack, call once
+   *  per loop()
+   *
+   * @return true if a keyframe or delta of the group came in
+   */
+  bool Poll();
+
+  // TALLY_FRAME_OFF/PREVIEW/PROGRAM of a 0-based camera
+  uint8_t State(uint8_t camera) const;
+  // millis() of the last frame of the group, 0 before the first
+  unsigned long ReceivedAt() const { return _received_at; }
+  bool InSync() const { return _in_sync; }
+  uint8_t Lost() const { return _lost; }
+  uint16_t Errors() const { return _decoder.Errors(); }
+};
+
+#endif
@@ -0,0 +1,48 @@
+/**
+ * Reference tally receiver: one camera light driven by the RF frames of the
+ * transmitter (see libs/TallyFrame). Needs the TallyFrame library installed.
+ */
+#include <SoftwareSerial.h>
+#include <TallyFrame.h>
+#include <TallyReceiver.h>
+
+// 1-based camera this light shows, and the transmitter's tally group
+#define RECEIVER_CAMERA 1
+#define RECEIVER_GROUP 0
+// unique per receiver on the channel, also its ack slot
+#define RECEIVER_ID (RECEIVER_CAMERA - 1)
+// ack frames back to the transmitter, -DRECEIVER_ACKS=1, only with a
+// transmitter built with -DRF_ACKS=1
+#ifndef RECEIVER_ACKS
+#define RECEIVER_ACKS 0
+#endif
+
+#define PIN_PROGRAM 4  // red
+#define PIN_PREVIEW 5  // green
+// no frame for this long: the transmitter is gone, the light goes dark
+#define RECEIVER_TIMEOUT_MS 3000
+
+SoftwareSerial RF(8, 9);  // RX, TX
+TallyReceiver receiver(&RF, RECEIVER_ID, RECEIVER_GROUP);
+
+void Show(uint8_t state) {
+  digitalWrite(PIN_PROGRAM, state == TALLY_FRAME_PROGRAM ? HIGH : LOW);
+  digitalWrite(PIN_PREVIEW, state == TALLY_FRAME_PREVIEW ? HIGH : LOW);
+}
+
+void setup() {
+  pinMode(PIN_PROGRAM, OUTPUT);
+  pinMode(PIN_PREVIEW, OUTPUT);
+  Show(TALLY_FRAME_OFF);
+  RF.begin(9600);
+  receiver.UseAcks(RECEIVER_ACKS);
+}
+
+void loop() {
+  if (receiver.Poll()) {
+    Show(receiver.State(RECEIVER_CAMERA - 1));
+  } else if (receiver.ReceivedAt() &&
+             millis() - receiver.ReceivedAt() > RECEIVER_TIMEOUT_MS) {
+    Show(TALLY_FRAME_OFF);
+  }
+}
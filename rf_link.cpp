@@ -0,0 +1,384 @@
+#include "rf_link.h"
+
+RfLink::RfLink(Stream* port) : _port(port) { SetAirtimeBudget(_budget); }
+
+void RfLink::SetAirtimeBudget(uint16_t bytes_per_s) {
+  _budget = bytes_per_s;
+  // a quarter second of airtime, so no second carries more than 5/4 of the
+  // budget, but always room for the longest frame
+  _credit_max = (uint32_t)_budget * 250;
+  if (_credit_max < (uint32_t)TALLY_FEC_LENGTH(RF_FRAME_LENGTH) * 1000) {
+    _credit_max = (uint32_t)TALLY_FEC_LENGTH(RF_FRAME_LENGTH) * 1000;
+  }
+  _credit = _credit_max;
+}
+
+void RfLink::Update(uint8_t group, const uint8_t* camera_status,
+                    uint8_t cameras) {
+  if (group >= TALLY_GROUPS) {
+    return;
+  }
+  if (cameras > MAX_TALLY) {
+    cameras = MAX_TALLY;
+  }
+  uint8_t bit = 1 << group;
+  bool changed = false;
+  bool on_air = false;
+  // a different camera count (Roland serial has 4) needs a keyframe
+  if (cameras != _cameras) {
+    _cameras = cameras;
+    memset(_sent, 0xFF, sizeof(_sent));
+    memset(_key, 0xFF, sizeof(_key));
+    _held = 0;
+  }
+  // STATUS_OFF/PREVIEW/PROGRAM are '0' + the frame's camera state
+  for (uint8_t camera = 0; camera < cameras; camera++) {
+    uint8_t state = camera_status[camera] - STATUS_OFF;
+    if (state == TallyFrameGetState(_states[group], camera)) {
+      continue;
+    }
+    changed = true;
+    if (state == TALLY_FRAME_PROGRAM &&
+        TallyFrameGetState(_sent[group], camera) != TALLY_FRAME_PROGRAM) {
+      on_air = true;
+    }
+    TallyFrameSetState(_states[group], camera, state);
+  }
+  if (_dirty & bit) {
+    if (changed) {
+      _stats.merged++;
+    }
+  } else if (_hold_ms) {
+    _held |= bit;
+    _release_at[group] = millis() + _hold_ms;
+  }
+  // a camera going on air takes everything with it (see RfLink), and
+  // nothing is held while there is no sent state to show instead
+  if (on_air || _sent[group][0] == 0xFF) {
+    _held &= ~bit;
+  }
+  _dirty |= bit;
+}
+
+/**
+ * @brief writes one frame of the group if the airtime allows it
+ *
+ * @param since keyframe: nullptr, delta: the states the receivers are
+ *  assumed to have; a keyframe is sent if the delta would not be shorter
+ * @param states what to send, nullptr for the group's current states (the
+ *  ones last sent while a change is held)
+ * @return false if it has to wait for airtime
+ */
+bool RfLink::Send(uint8_t group, bool keyframe, const uint8_t* since,
+                  const uint8_t* states) {
+  // a held change is not on air yet
+  if (!states) {
+    states = (_held & (1 << group)) ? _sent[group] : _states[group];
+  }
+  uint8_t len = 0;
+  // nothing to list in a delta: the repeat of a change a keyframe already
+  // carried, send that keyframe again instead
+  if (!keyframe && !memcmp(since, states, TALLY_FRAME_STATE_BYTES(_cameras))) {
+    keyframe = true;
+  }
+  if (!keyframe) {
+    len = TallyFrameEncodeDelta(_frame, group, _sequence[group], states,
+                                since, _cameras);
+  }
+  if (!len) {
+    len = TallyFrameEncodeKey(_frame, group, _sequence[group], states,
+                              _cameras);
+  }
+  uint8_t on_air = TALLY_FEC_LENGTH(len);
+  if (_credit < (uint32_t)on_air * 1000) {
+    _stats.deferred++;
+    return false;
+  }
+  _credit -= (uint32_t)on_air * 1000;
+  TallyFrameWrite(_port, _frame, len);
+
+  if (((_frame[1] >> 3) & 0x03) == TALLY_FRAME_KEY) {
+    memcpy(_key[group], states, RF_STATE_BYTES);
+  }
+  memcpy(_sent[group], states, RF_STATE_BYTES);
+  _sequence[group]++;
+  _stats.bytes += on_air;
+#if RF_ACKS
+  uint8_t sequence = _frame[2];
+  bool delta = ((_frame[1] >> 3) & 0x03) == TALLY_FRAME_DELTA;
+  // the receivers drop the acks a keyframe makes redundant
+  if (!delta) {
+    _expected[group] = 0;
+  }
+  for (uint8_t id = 0; id < RF_RECEIVERS; id++) {
+    if (!_receivers[id].active || _receivers[id].group != group) {
+      continue;
+    }
+    _receivers[id].frames++;
+    if (delta || (_behind[group] & (1 << id)) ||
+        sequence % TALLY_FRAME_ACK_SLOTS == id % TALLY_FRAME_ACK_SLOTS) {
+      _expected[group] |= 1 << id;
+    }
+  }
+  // the receivers start their slots over after every frame
+  _awaiting |= 1 << group;
+  _ack_due = millis() + RF_ACK_WINDOW_MS;
+#endif
+  return true;
+}
+
+/**
+ * @brief what the receivers have with only the cameras that go to program
+ *  changed
+ *
+ * @return false if that is no news or already all of it
+ */
+bool RfLink::StageProgram(uint8_t group, uint8_t* staged) const {
+  bool program = false;
+  bool rest = false;
+  memcpy(staged, _sent[group], RF_STATE_BYTES);
+  for (uint8_t camera = 0; camera < _cameras; camera++) {
+    uint8_t state = TallyFrameGetState(_states[group], camera);
+    if (state == TallyFrameGetState(_sent[group], camera)) {
+      continue;
+    }
+    if (state == TALLY_FRAME_PROGRAM) {
+      TallyFrameSetState(staged, camera, state);
+      program = true;
+    } else {
+      rest = true;
+    }
+  }
+  return program && rest;
+}
+
+#if RF_ACKS
+bool RfLink::HasReceivers(uint8_t group) const {
+  for (uint8_t id = 0; id < RF_RECEIVERS; id++) {
+    if (_receivers[id].active && _receivers[id].group == group) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void RfLink::ReadAcks() {
+  while (_port->available()) {
+    _heard_at = millis();
+    TallyFrameAck ack;
+    if (!_acks.Push(_port->read()) || !_acks.Ack(&ack) ||
+        ack.receiver >= RF_RECEIVERS || ack.group >= TALLY_GROUPS ||
+        (uint8_t)(_sequence[ack.group] - 1 - ack.sequence) >= RF_ACK_HISTORY) {
+      continue;
+    }
+    RfReceiver& receiver = _receivers[ack.receiver];
+    if (!receiver.active || receiver.group != ack.group) {
+      Log.notice("RF receiver %d on group %d" CR, ack.receiver, ack.group);
+      receiver.active = true;
+      receiver.group = ack.group;
+    } else {
+      // more losses than frames sent: noise that passed the CRC
+      uint8_t lost = ack.lost - receiver.lost_at;
+      if (lost > receiver.frames - receiver.frames_at) {
+        continue;
+      }
+      receiver.lost += lost;
+    }
+    receiver.lost_at = ack.lost;
+    receiver.frames_at = receiver.frames;
+    receiver.sequence = ack.sequence;
+    receiver.flags = ack.flags;
+    receiver.errors = ack.errors;
+    receiver.rssi = ack.rssi;
+    receiver.acks++;
+    receiver.acked = true;
+    receiver.misses = 0;
+    _stats.acks++;
+  }
+}
+
+// the ack window is over: is anyone of the group behind?
+void RfLink::CloseAckWindow(uint8_t group) {
+  uint8_t behind = 0;
+  for (uint8_t id = 0; id < RF_RECEIVERS; id++) {
+    RfReceiver& receiver = _receivers[id];
+    uint8_t bit = 1 << id;
+    if (!receiver.active || receiver.group != group) {
+      continue;
+    }
+    if (receiver.acked) {
+      if (!(receiver.flags & TALLY_FRAME_ACK_IN_SYNC) ||
+          receiver.sequence != (uint8_t)(_sequence[group] - 1)) {
+        behind |= bit;
+      }
+    } else if (_expected[group] & bit) {
+      receiver.missed_acks++;
+      if (++receiver.misses >= RF_ACK_MISSES) {
+        Log.notice("RF receiver %d lost" CR, id);
+        receiver.active = false;
+        continue;
+      }
+      behind |= bit;
+    }
+    receiver.acked = false;
+  }
+  _expected[group] = 0;
+  _behind[group] = behind;
+  if (behind && _retries[group]) {
+    _retries[group]--;
+    _retransmit |= 1 << group;
+  }
+}
+
+void RfLink::DumpReceivers() const {
+  for (uint8_t id = 0; id < RF_RECEIVERS; id++) {
+    const RfReceiver& receiver = _receivers[id];
+    if (!receiver.acks) {
+      continue;
+    }
+    Log.notice(
+        "RF receiver %d group %d %s: %u frames, %u lost, %u acks, %u missed, "
+        "%d errors, rssi %d" CR,
+        id, receiver.group, receiver.active ? "up" : "down", receiver.frames,
+        receiver.lost, receiver.acks, receiver.missed_acks, receiver.errors,
+        receiver.rssi);
+  }
+}
+#endif
+
+void RfLink::Poll() {
+  unsigned long now = millis();
+  _credit += (uint32_t)(now - _credit_at) * _budget;
+  if (_credit > _credit_max) {
+    _credit = _credit_max;
+  }
+  _credit_at = now;
+
+#if RF_ACKS
+  ReadAcks();
+  if (_awaiting && (long)(now - _ack_due) >= 0) {
+    for (uint8_t group = 0; group < TALLY_GROUPS; group++) {
+      if (_awaiting & (1 << group)) {
+        CloseAckWindow(group);
+      }
+    }
+    _awaiting = 0;
+  }
+  // an ack is on the air
+  if (now - _heard_at < TALLY_FRAME_QUIET_MS) {
+    return;
+  }
+#endif
+
+  // new changes first, cameras going on air ahead of the rest (even of
+  // other groups); while they wait for airtime, later changes of the same
+  // group merge into the same delta
+  uint8_t split = 0;
+  if (_program_first) {
+    for (uint8_t group = 0; group < TALLY_GROUPS; group++) {
+      if (!(_dirty & (1 << group))) {
+        continue;
+      }
+      uint8_t staged[RF_STATE_BYTES];
+      if (!StageProgram(group, staged)) {
+        continue;
+      }
+      if (!Send(group, false, _sent[group], staged)) {
+        return;
+      }
+      _stats.programs++;
+      split |= 1 << group;
+    }
+  }
+  for (uint8_t group = 0; group < TALLY_GROUPS; group++) {
+    uint8_t bit = 1 << group;
+    if (!(_dirty & bit)) {
+      continue;
+    }
+    if (_held & bit) {
+      if ((long)(now - _release_at[group]) < 0) {
+        continue;
+      }
+#if RF_ACKS
+      // no hurry, do not talk over the acks
+      if ((_awaiting & bit) && HasReceivers(group)) {
+        continue;
+      }
+#endif
+    }
+    _held &= ~bit;
+    if (!memcmp(_sent[group], _states[group],
+                TALLY_FRAME_STATE_BYTES(_cameras))) {
+      _dirty &= ~bit;
+      continue;
+    }
+    bool keyframe = false;
+#if RF_ACKS
+    // every receiver acks a delta, one ack round for both frames: the
+    // keyframe clears the acks the program frame asked for
+    keyframe = (split & bit) && HasReceivers(group);
+#endif
+    if (!Send(group, keyframe, _sent[group])) {
+      return;
+    }
+    _stats.deltas++;
+    _dirty &= ~bit;
+    _repeats[group] = _repeat_count;
+    _repeat_at[group] = now + _repeat_ms;
+#if RF_ACKS
+    _retries[group] = _repeat_count;
+#endif
+  }
+
+#if RF_ACKS
+  // the rest waits for the acks
+  if (_awaiting) {
+    return;
+  }
+  for (uint8_t group = 0; _retransmit; group++) {
+    if (!(_retransmit & (1 << group))) {
+      continue;
+    }
+    if (!Send(group, true, nullptr)) {
+      return;
+    }
+    _stats.retransmits++;
+    _retransmit &= ~(1 << group);
+    return;
+  }
+#endif
+
+  // one repeat or keyframe per call, so a burst never stalls loop()
+  for (uint8_t group = 0; group < TALLY_GROUPS; group++) {
+    if (!_repeats[group] || (long)(now - _repeat_at[group]) < 0) {
+      continue;
+    }
+#if RF_ACKS
+    if (HasReceivers(group)) {
+      _repeats[group] = 0;
+      continue;
+    }
+#endif
+    // everything since the last keyframe, a receiver that lost the first
+    // delta or any before it catches up from this one
+    if (!Send(group, false, _key[group])) {
+      return;
+    }
+    _stats.repeats++;
+    _repeats[group]--;
+    _repeat_at[group] = now + _repeat_ms;
+    return;
+  }
+
+  if (_keyframe_ms && (long)(now - _key_at) >= 0) {
+    if (!Send(_key_group, true, nullptr)) {
+      return;
+    }
+    _stats.keyframes++;
+#if RF_ACKS
+    _retries[_key_group] = _repeat_count;
+#endif
+    _key_group = (_key_group + 1) % TALLY_GROUPS;
+    _key_at = now + _keyframe_ms / TALLY_GROUPS;
+  }
+}
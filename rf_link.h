@@ -0,0 +1,205 @@
+#ifndef RF_LINK_h
+#define RF_LINK_h
+
+#include <Arduino.h>
+#include <TallyFec.h>
+#include <TallyFrame.h>
+
+#include "tally.h"
+
+// full state of every group is sent at least this often, so a receiver
+// switched on mid-show or one that lost a frame converges within it
+#ifndef RF_KEYFRAME_MS
+#define RF_KEYFRAME_MS 1000
+#endif
+// every change is sent once more this many times, RF_REPEAT_MS apart
+#ifndef RF_REPEATS
+#define RF_REPEATS 2
+#endif
+#ifndef RF_REPEAT_MS
+#define RF_REPEAT_MS 40
+#endif
+// a change that puts no camera on program waits this long for the next
+// ones and goes out merged with them, 0 sends every change at once
+#ifndef RF_HOLD_MS
+#define RF_HOLD_MS 50
+#endif
+// bytes per second the link may use, 9600 baud carries 960
+#ifndef RF_AIRTIME_BUDGET
+#define RF_AIRTIME_BUDGET 480
+#endif
+
+// acknowledged mode, -DRF_ACKS=1: receivers started with UseAcks(true) ack
+// every frame, and changes are sent again only while one of them is behind.
+// RF has to be the listening SoftwareSerial, so not with Roland over RS-232.
+#ifndef RF_ACKS
+#define RF_ACKS 0
+#endif
+// receiver ids 0 to RF_RECEIVERS - 1 are tracked
+#ifndef RF_RECEIVERS
+#define RF_RECEIVERS TALLY_FRAME_ACK_SLOTS
+#endif
+#if RF_RECEIVERS > TALLY_FRAME_ACK_SLOTS
+#error "RF_RECEIVERS exceeds the ack slots, their acks would collide"
+#endif
+// a receiver that misses this many acks in a row is not waited for
+#define RF_ACK_MISSES 3
+// acks for frames older than this are taken for noise
+#define RF_ACK_HISTORY 16
+#define RF_ACK_WINDOW_MS ((TALLY_FRAME_ACK_SLOTS + 2) * TALLY_FRAME_ACK_SLOT_MS)
+
+#define RF_FRAME_LENGTH \
+  (TALLY_FRAME_HEADER_LENGTH + TALLY_FRAME_STATE_BYTES(MAX_TALLY) + 1)
+#define RF_STATE_BYTES TALLY_FRAME_STATE_BYTES(MAX_TALLY)
+
+struct RfStats {
+  uint32_t bytes;
+  uint16_t deltas;     // one per change
+  uint16_t programs;   // cameras going to program, sent ahead of a delta
+  uint16_t merged;     // changes that joined one still waiting, frames saved
+  uint16_t repeats;    // the same change again
+  uint16_t keyframes;  // periodic full state
+  uint32_t deferred;   // Poll() calls that had to wait for airtime
+  uint16_t retransmits;  // keyframes for receivers that were behind
+  uint16_t acks;
+};
+
+/**
+ * @brief what the transmitter knows of one receiver, from its acks
+ */
+struct RfReceiver {
+  bool active;  // acked lately, retransmits wait for it
+  uint8_t group;
+  uint8_t sequence;  // last frame it acked
+  uint8_t flags;     // TALLY_FRAME_ACK_IN_SYNC
+  uint8_t errors;
+  uint8_t rssi;
+  uint16_t frames;       // frames of its group sent while it was active
+  uint16_t lost;         // of those, the ones it reported missing
+  uint16_t acks;
+  uint16_t missed_acks;  // ack windows that closed without its ack
+
+  bool acked;         // in the current window
+  uint8_t misses;     // expected acks in a row that did not come
+  uint8_t lost_at;    // its lost counter in the previous ack
+  uint16_t frames_at; // frames in the previous ack
+};
+
+/**
+ * @brief schedules the RF frames of all tally groups
+ *
+ * A change is sent right away as a delta (see TallyFrameEncodeDelta), then
+ * repeated. When a change also turns cameras to program, those go first in
+ * a short delta of their own, ahead of every other frame, and previews and
+ * clears follow in the next one: a red light is never late for the rest.
+ * A change that turns no camera to program is held for the hold time
+ * first, so whatever changes within it (a T-bar drag, preview selection)
+ * goes out as one delta, or not at all if it changed back; until then
+ * repeats and keyframes carry what was sent before. The rest of a cut is
+ * not held: following the program frame at once, it doubles as its repeat
+ * (a lost red light is back within a frame) and takes one ack round for
+ * both. Holding it would merge fast cuts, but costs a second ack round per
+ * cut, more airtime than the merged frames save, and delays the green
+ * lights by the hold time (see bench/sim_rf_link --burst).
+ * Keyframes go out round robin over the groups so each one is refreshed
+ * every keyframe interval. Everything is paced by a token bucket of
+ * airtime: when it is empty, changes wait (and merge) before repeats and
+ * keyframes, and nothing is written to the port, which also bounds how long
+ * SoftwareSerial blocks loop().
+ *
+ * With RF_ACKS, every frame opens (or extends) the ack window, and the
+ * receivers that have to ack it by the rules in TallyFrame.h are expected.
+ * Repeats and keyframes wait until the window is closed, so they do not
+ * talk over the acks. When it closes with a receiver behind (an expected
+ * ack missing, not in sync, or an older sequence), the group's keyframe is
+ * sent again, at most RF_REPEATS times per change. Groups without receivers
+ * that ack keep the blind repeats.
+ */
+class RfLink {
+ private:
+  Stream* _port;
+  uint16_t _keyframe_ms = RF_KEYFRAME_MS;
+  uint8_t _repeat_count = RF_REPEATS;
+  uint16_t _repeat_ms = RF_REPEAT_MS;
+  uint16_t _budget = RF_AIRTIME_BUDGET;
+  uint16_t _hold_ms = RF_HOLD_MS;
+  bool _program_first = true;
+
+  // airtime in 1/1000 byte, refilled at _budget bytes/s
+  uint32_t _credit;
+  uint32_t _credit_max;
+  unsigned long _credit_at = 0;
+
+  uint8_t _cameras = MAX_TALLY;
+  uint8_t _states[TALLY_GROUPS][RF_STATE_BYTES] = {{0}};
+  // what the last frame of the group and its last keyframe carried
+  uint8_t _sent[TALLY_GROUPS][RF_STATE_BYTES] = {{0}};
+  uint8_t _key[TALLY_GROUPS][RF_STATE_BYTES] = {{0}};
+  uint8_t _dirty = 0;
+  uint8_t _held = 0;  // dirty groups whose change waits for _release_at
+  unsigned long _release_at[TALLY_GROUPS] = {0};
+  uint8_t _repeats[TALLY_GROUPS] = {0};
+  unsigned long _repeat_at[TALLY_GROUPS] = {0};
+  uint8_t _key_group = 0;
+  unsigned long _key_at = 0;
+
+  uint8_t _sequence[TALLY_GROUPS] = {0};
+  uint8_t _frame[RF_FRAME_LENGTH];
+  RfStats _stats = {};
+
+#if RF_ACKS
+  TallyLinkDecoder _acks;
+  RfReceiver _receivers[RF_RECEIVERS] = {};
+  uint8_t _awaiting = 0;  // groups with frames in the open ack window
+  unsigned long _ack_due = 0;
+  unsigned long _heard_at = 0;
+  // bit per receiver id
+  uint8_t _expected[TALLY_GROUPS] = {0};
+  uint8_t _behind[TALLY_GROUPS] = {0};
+  uint8_t _retries[TALLY_GROUPS] = {0};
+  uint8_t _retransmit = 0;
+
+  void ReadAcks();
+  void CloseAckWindow(uint8_t group);
+  bool HasReceivers(uint8_t group) const;
+#endif
+
+  bool Send(uint8_t group, bool keyframe, const uint8_t* since,
+            const uint8_t* states = nullptr);
+  bool StageProgram(uint8_t group, uint8_t* staged) const;
+
+ public:
+  explicit RfLink(Stream* port);
+
+  // 0 disables keyframes
+  void SetKeyframeInterval(uint16_t ms) { _keyframe_ms = ms; }
+  void SetRepeats(uint8_t count, uint16_t spacing_ms) {
+    _repeat_count = count;
+    _repeat_ms = spacing_ms;
+  }
+  void SetAirtimeBudget(uint16_t bytes_per_s);
+  // send the cameras that go on air in a frame of their own, ahead of the
+  // rest of the change (on by default)
+  void SetProgramFirst(bool enabled) { _program_first = enabled; }
+  // how long changes without a camera going on air wait to merge, 0 = none
+  void SetHoldTime(uint16_t ms) { _hold_ms = ms; }
+
+  /**
+   * @brief takes the new status of a group, as returned by
+   *  Tally::CameraStatus(), for the next Poll()
+   */
+  void Update(uint8_t group, const uint8_t* camera_status, uint8_t cameras);
+
+  // send whatever is due, call once per loop()
+  void Poll();
+
+  const RfStats& Stats() const { return _stats; }
+
+#if RF_ACKS
+  const RfReceiver& Receiver(uint8_t id) const { return _receivers[id]; }
+  // logs the link quality of every receiver that ever acked
+  void DumpReceivers() const;
+#endif
+};
+
+#endif
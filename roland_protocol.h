@@ -0,0 +1,99 @@
+#ifndef ROLAND_PROTOCOL_h
+#define ROLAND_PROTOCOL_h
+
+#include <Arduino.h>
+
+#define ROLAND_STX 0x02
+#define ROLAND_ACK 0x06
+
+typedef enum rolandTallyParam {
+  PGM,
+  PST,
+  PinP,
+  SPLIT,
+  DSK,
+  TRANSITION,
+  FADE,
+  FADER,
+  MAXPARAM
+} ROLAND_PARAM;
+
+/**
+ * @brief decodes stxQPL:a,b,...; responses one byte at a time
+ *
+ * The parser keeps its state between calls, so a frame split over any
+ * number of loop() calls is still decoded, and the integers are accumulated
+ * as their digits arrive: no buffer of the raw text, no heap. A frame is
+ * complete on ';' (or an ACK in its place) once PGM and PST were read. STX
+ * always starts a new frame, anything unexpected drops the current one.
+ */
+class RolandQplParser {
+ private:
+  enum { WAIT_STX, HEADER, FIELDS } _state = WAIT_STX;
+  uint8_t _header_pos = 0;
+  uint8_t _params[MAXPARAM] = {0};
+  uint8_t _count = 0;
+  uint16_t _value = 0;
+
+  void Store() {
+    if (_count < MAXPARAM) {
+      _params[_count] = _value > 255 ? 255 : _value;
+    }
+    _count++;
+    _value = 0;
+  }
+
+ public:
+  /**
+   * @return true once c completes a QPL frame, see Param() and Count(); the
+   *  values stay valid until the next frame starts
+   */
+  bool Push(uint8_t c) {
+    static const char kHeader[] PROGMEM = "QPL:";
+    if (c == ROLAND_STX) {
+      _state = HEADER;
+      _header_pos = 0;
+      return false;
+    }
+    switch (_state) {
+      case HEADER:
+        if (c != pgm_read_byte(&kHeader[_header_pos])) {
+          _state = WAIT_STX;
+        } else if (++_header_pos == sizeof(kHeader) - 1) {
+          _state = FIELDS;
+          _count = 0;
+          _value = 0;
+        }
+        return false;
+      case FIELDS:
+        if (c >= '0' && c <= '9') {
+          _value = _value * 10 + (c - '0');
+          if (_value > 999) {
+            _value = 999;
+          }
+          return false;
+        }
+        if (c == ',') {
+          Store();
+          return false;
+        }
+        _state = WAIT_STX;
+        if (c == ';' || c == ROLAND_ACK) {
+          Store();
+          return _count > PST;
+        }
+        return false;
+      case WAIT_STX:
+      default:
+        return false;
+    }
+  }
+
+  // value of one parameter of the last frame, 0 if it was not sent
+  uint8_t Param(ROLAND_PARAM param) const {
+    return param < _count ? _params[param] : 0;
+  }
+  uint8_t Count() const { return _count < MAXPARAM ? _count : (uint8_t)MAXPARAM; }
+};
+
+#endif
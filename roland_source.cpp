@@ -0,0 +1,164 @@
+#include "roland_source.h"
+
+#if TALLY_ROLAND
+
+void RolandSource::Begin() {
+  ClearCameras();
+  if (_lan) {
+    _connection.Begin();
+  } else {
+    _serial.begin(9600);
+  }
+  Restart();
+  _answered = false;
+  _started = true;
+}
+
+// the parser, poll scheduler and push detection start over
+void RolandSource::Restart() {
+  _qpl = RolandQplParser();
+  _unsolicited = 0;
+  _solicited = 0;
+  _requested = 0;
+  _waiting = false;
+  _interval_ms = ROLAND_POLL_MIN_MS;
+  _sent_at = millis() - ROLAND_POLL_MIN_MS;
+  _heard_at = millis();
+}
+
+void RolandSource::Poll() {
+  if (!_started) {
+    return;
+  }
+  if (_lan && _connection.Advance()) {
+    // a new connection, maybe to another switcher
+    Restart();
+  }
+  if (_lan && _connection.State() != CLIENT_SUBSCRIBED) {
+    return;
+  }
+  // a frame split over several calls is picked up where it was left
+  Stream* port = Port();
+  for (int pending = port->available(); pending > 0; pending--) {
+    if (_qpl.Push(port->read())) {
+      HandleData();
+    }
+  }
+  Request();
+}
+
+void RolandSource::Teardown() {
+  if (_lan) {
+    _connection.Stop();
+  } else {
+    _serial.end();
+  }
+  _started = false;
+  ClearCameras();
+}
+
+SOURCE_HEALTH RolandSource::Health() {
+  if (!_started) {
+    return SOURCE_DOWN;
+  }
+  if (_lan && _connection.State() != CLIENT_SUBSCRIBED) {
+    return _connection.Health();
+  }
+  return _answered ? SOURCE_UP : SOURCE_CONNECTING;
+}
+
+/**
+ * @brief handle data from ROLAND
+ *  stxQPL:b;
+ *  Response command parameters
+ *    when a=0, b: 0 (CH 1)–3 (CH 4) PGM
+ *    When a=1, b: 0 (CH 1)–3 (CH 4) PST
+ *    When a=2, b: 0 (OFF), 1 (ON) [PinP] button
+ *    When a=3, b: 0 (OFF), 1 (ON) [SPLIT] button
+ *    When a=4, b: 0 (OFF), 1 (ON) [DSK] button
+ *    When a=5, b: 0 (WIPE), 1 (MIX), 2 (CUT) TRANSITION buttons
+ *    When a=6, b: 0–255 Output fade level
+ *                 0: black, 255: white, 128: center
+ *    When a=7, b: 0–255 Output level of A/B fader
+ *                 0: bus B end, 255: bus A end, 128: center
+ *    When a=8, sends all information described above.
+ *    Example: stxQPL:0,1,0,1,1,0,100,255;
+ *  decoded by _qpl as the bytes arrive, this runs once per frame
+ */
+void RolandSource::HandleData() {
+  // status sent without any request outstanding, timed out ones included:
+  // after a few of them the switcher is taken to push its changes, polling
+  // is only kept as a slow resync, until a long run of frames that all
+  // answered requests. RS-232 (V-1HD) only answers requests.
+  if (_requested) {
+    _requested--;
+    if (++_solicited >= ROLAND_PUSH_DECAY_FRAMES) {
+      _solicited = 0;
+      _unsolicited = 0;
+    }
+  } else if (_lan) {
+    _solicited = 0;
+    if (_unsolicited < ROLAND_PUSH_FRAMES) {
+      _unsolicited++;
+    }
+  }
+  // the request is answered, the next one may go out
+  _waiting = false;
+  _heard_at = millis();
+  _answered = true;
+  _connection.Answered();
+  if (Push()) {
+    _interval_ms = ROLAND_POLL_MAX_MS;
+  } else {
+    _interval_ms -= (_interval_ms - ROLAND_POLL_MIN_MS) / 4;
+  }
+
+  uint8_t pgm = _qpl.Param(PGM);
+  uint8_t pst = _qpl.Param(PST);
+  // set all status tally to off
+  ClearCameras();
+  // assign PGM LED and PST LED
+  SetCamera(0, pst, false, true);
+  SetCamera(0, pgm, true, pgm == pst);
+}
+
+/**
+ * @brief request the panel status (stxQPL:8;) from the main loop
+ *  The next request goes out as soon as the previous response was parsed,
+ *  but not sooner than _interval_ms after the previous one. A request
+ *  without response for ROLAND_TIMEOUT_MS is given up and the interval
+ *  doubled (up to ROLAND_POLL_MAX_MS); every response brings it back down a
+ *  quarter of the way to ROLAND_POLL_MIN_MS.
+ *  SoftwareSerial TX blocks for ~1 ms per byte, which used to happen inside
+ *  the Timer1 interrupt.
+ */
+void RolandSource::Request() {
+  unsigned long now = millis();
+  if (_waiting) {
+    if (now - _sent_at < ROLAND_TIMEOUT_MS) {
+      return;
+    }
+    Log.warning("ROLAND did not answer" CR);
+    _waiting = false;
+    _answered = false;
+    if (now - _heard_at >= ROLAND_LATE_MS) {
+      _requested = 0;
+    }
+    _interval_ms = _interval_ms < ROLAND_POLL_MAX_MS / 2 ? _interval_ms * 2
+                                                         : ROLAND_POLL_MAX_MS;
+  }
+  if (now - _sent_at < _interval_ms) {
+    return;
+  }
+  // request to ROLAND->stxQPL : 8;
+  const uint8_t roland_request[] = {ROLAND_STX, 0x51, 0x50, 0x4C,
+                                    0x3A,       0x38, 0x3B};
+  Port()->write(roland_request, sizeof(roland_request));
+  _sent_at = now;
+  _waiting = true;
+  if (_requested < 255) {
+    _requested++;
+  }
+}
+
+#endif  // TALLY_ROLAND
@@ -0,0 +1,90 @@
+#ifndef ROLAND_SOURCE_h
+#define ROLAND_SOURCE_h
+
+#include "tally_source.h"
+
+#if TALLY_ROLAND
+
+#include <SoftwareSerial.h>
+
+#include "roland_protocol.h"
+
+#define rolandTX 6
+#define rolandRX 7
+// channels of the serial V-1HD; V-60HD/V-160HD class switchers on LAN report
+// more, up to MAX_TALLY are used
+#define ROLAND_SERIAL_CHANNELS 4
+// Roland status polling: requests are sent back to back as responses come
+// in, but never closer than the adaptive interval, which starts at the
+// minimum and doubles (up to the maximum) on every request left unanswered
+// for ROLAND_TIMEOUT_MS
+#ifndef ROLAND_POLL_MIN_MS
+#define ROLAND_POLL_MIN_MS 20
+#endif
+#define ROLAND_POLL_MAX_MS 300
+#define ROLAND_TIMEOUT_MS 150
+// requests still unanswered after this long without any frame are not
+// expected to be answered any more
+#define ROLAND_LATE_MS 1000
+// status frames received on LAN without a request outstanding before the
+// switcher is taken to push its changes and polling slows down to
+// ROLAND_POLL_MAX_MS
+#define ROLAND_PUSH_FRAMES 3
+// answers in a row that all had a request outstanding before the frames
+// not asked for are forgotten, and push mode ends (a minute of resyncs)
+#define ROLAND_PUSH_DECAY_FRAMES 200
+
+/**
+ * @brief Roland switchers polled with stxQPL:8; over RS-232 (V-1HD, pins
+ *  rolandRX/rolandTX) or with UseLan() over TCP 8023 (V-60HD/V-160HD)
+ */
+class RolandSource : public TallySource {
+ private:
+  SoftwareSerial _serial;
+  SourceClient _connection;
+  RolandQplParser _qpl;
+  bool _lan = false;
+  // unsolicited frames so far, up to ROLAND_PUSH_FRAMES
+  uint8_t _unsolicited = 0;
+  // frames with a request outstanding since the last unsolicited one
+  uint8_t _solicited = 0;
+  // requests not answered yet, also the ones that timed out: a slow
+  // switcher still answers them, in order (up to ROLAND_LATE_MS)
+  uint8_t _requested = 0;
+  bool _waiting = false;
+  // the last request was answered, or a status pushed
+  bool _answered = false;
+  bool _started = false;
+  uint16_t _interval_ms = ROLAND_POLL_MIN_MS;
+  unsigned long _sent_at = 0;
+  unsigned long _heard_at = 0;
+
+  Stream* Port() {
+    return _lan ? (Stream*)&_connection.Client() : (Stream*)&_serial;
+  }
+  bool Push() const { return _unsolicited >= ROLAND_PUSH_FRAMES; }
+  void Restart();
+  void HandleData();
+  void Request();
+
+ public:
+  explicit RolandSource(IPAddress server, uint16_t port = 8023)
+      : _serial(rolandRX, rolandTX), _connection("ROLAND", server, port) {}
+
+  // V-60HD/V-160HD over LAN (TCP 8023) instead of RS-232
+  void UseLan(bool lan) { _lan = lan; }
+  bool Lan() const { return _lan; }
+
+  void Begin() override;
+  void Poll() override;
+  void Teardown() override;
+  SOURCE_HEALTH Health() override;
+  const char* Name() override { return "ROLAND"; }
+  uint8_t Cameras() override {
+    return _lan ? MAX_TALLY : ROLAND_SERIAL_CHANNELS;
+  }
+};
+
+#endif  // TALLY_ROLAND
+
+#endif
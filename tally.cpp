@@ -1,7 +1,6 @@
 #include "tally.h"
 
 Tally* Tally::m_instance = nullptr;
-SoftwareSerial Tally::_roland = SoftwareSerial(rolandRX, rolandTX);
 
 Tally* Tally::Instance() {
   if (!m_instance) {
@@ -11,13 +10,11 @@ Tally* Tally::Instance() {
 }
 
 Tally::Tally()
-    : _mac{0x00, 0xAA, 0xBB, 0xCC, 0xDE, 0x02},
-      _ip(192, 168, 0, 177),
-      _vmix_server(192, 168, 0, 100),
-      _atem_server(192, 168, 0, 100) {}
+    : _mac{0x00, 0xAA, 0xBB, 0xCC, 0xDE, 0x02}, _ip(192, 168, 0, 177) {
+  memset(_camera_status, STATUS_OFF, sizeof(_camera_status));
+}
 
 void Tally::Begin() {
-  InitSwitchInput();
 retry:
   // To configure the CS pin
   Ethernet.init(CS_SPI);
@@ -39,253 +36,284 @@ retry:
   }
 
   IPAddress ip = Ethernet.localIP();
-  Log.notice("My IP address: %s.%s.%s.%s" CR, ip[0], ip[1], ip[2], ip[3]);
+  Log.notice("My IP address: %d.%d.%d.%d" CR, ip[0], ip[1], ip[2], ip[3]);
 }
 
-uint8_t* Tally::ProcessTally() {
-  bool is_change = false;
-  switch (_tally_type) {
-    case VMIX:
-      while (_client.available()) {
-        String data = _client.readStringUntil('\r\n');
-        is_change = HandleDataFromVmix(data);
-        if (is_change) {
-          for (uint8_t i = 0; i < MAX_TALLY; i++) {
-            Log.notice("%d" CR, _camera_status[i]);
-          }
-        }
-      }
-      // if (_client.available()) {
-      //   char c = client.read();
-      //   Serial.print(c);
-      // }
-      break;
-    case ATEM:
-      // Check for packets, respond to them etc. Keeping the connection alive!
-      // VERY important that this function is called all the time - otherwise
-      // connection might be lost because packets from the switcher is
-      // overlooked and not responded to.
-      _atem_switcher.runLoop();
-      HandleDataFromAtem();
-      break;
-    case ROLAND:
-      String input_string = "";
-      while (_roland.available()) {
-        // get the new byte
-        char inChar = (char)_roland.read();
-        // add it to the input_string
-        input_string += inChar;
-        // ACK (06H)
-        if (inChar == 0x06) {
-          HandleDataFromRoland(input_string);
-          is_change = true;
-        }
-      }
-      break;
-    default:
-      Log.error("device not support (%d)" CR, _tally_type);
-      break;
+/**
+ * @brief register a source, selected while its switch pin is pulled low
+ *  The source on DEVICE_DEFAULT's pin, or else the first one added, is
+ *  active until HandleSwitchDevice() finds a switch position.
+ *
+ * @param source driver, must outlive Tally
+ * @param select_pin switch input, one of TALLY_TYPE
+ * @return false if MAX_TALLY_SOURCES are registered already
+ */
+bool Tally::AddSource(TallySource* source, uint8_t select_pin) {
+  if (_source_count >= MAX_TALLY_SOURCES) {
+    return false;
+  }
+  pinMode(select_pin, INPUT);
+  _sources[_source_count] = source;
+  _source_pins[_source_count] = select_pin;
+  memset(_source_cameras[_source_count], 0xFF,
+         sizeof(_source_cameras[_source_count]));
+  _source_count++;
+  if (!_active || select_pin == DEVICE_DEFAULT) {
+    _active = source;
   }
-  return (is_change) ? _camera_status : nullptr;
+  return true;
 }
 
-void Tally::CheckConnection() {
-  switch (_tally_type) {
-    case VMIX:
-      if (!_client.connected()) {
-        Log.notice("disconnected Vmix" CR);
-        ConnectToVmix();
-      }
-      break;
-    case ATEM:
-      // // If connection is gone anyway, try to reconnect:
-      // if (_atem_switcher.isConnectionTimedOut()) {
-      //   Log.warning(
-      //       "Connection to ATEM Switcher has timed out - reconnecting!");
-      //   _atem_switcher.connect();
-      // }
-      break;
-    case ROLAND:
-      break;
-    default:
-      Log.error("device not support (%d)" CR, _tally_type);
-      break;
-  }
+/**
+ * @brief run every source added at once, e.g. an ATEM for the cameras next
+ *  to vMix for graphics and ISO, and report their tally merged. Call before
+ *  InitConnectionWithServerSide(); the device switch is ignored from then on.
+ *  Only sources that are up contribute, a source that lost its switcher
+ *  does not hold its last lights.
+ *
+ * @param policy MERGE_OR, or MERGE_PRIORITY in the order the sources were
+ *  added
+ */
+void Tally::RunAllSources(MERGE_POLICY policy) {
+  _run_all = true;
+  _merge = policy;
 }
 
-bool Tally::HandleDataFromVmix(String data) {
-  const String vmix_tally_rsp = "TALLY OK";
-  uint8_t new_state = 0;
-  uint8_t vmix_rsp_len = vmix_tally_rsp.length();
-  uint8_t data_len = data.length() - 1;
-  bool is_change = false;
-  // Check if server data is Tally data
-  if (data.indexOf(vmix_tally_rsp) == 0) {
-    for (uint8_t tally_number = 1;
-         tally_number <= MAX_TALLY && tally_number + vmix_rsp_len < data_len;
-         tally_number++) {
-      new_state = (uint8_t)data.charAt(tally_number + vmix_rsp_len);
-      if (new_state != _camera_status[tally_number - 1]) {
-        _camera_status[tally_number - 1] = new_state;
-        is_change = true;
-      }
-    }
+/**
+ * @brief take a camera's tally from one source only, whatever the others
+ *  report for it; for RunAllSources
+ *
+ * @param tally_number 1-based camera number
+ * @param source a source added with AddSource
+ * @return false if the camera is out of range or the source was not added
+ */
+bool Tally::AssignCamera(uint8_t tally_number, TallySource* source) {
+  if (tally_number < 1 || tally_number > MAX_TALLY) {
+    return false;
   }
-  Log.notice("Response from vMix: %s" CR, data.c_str());
-
-  return is_change;
+  uint8_t camera = tally_number - 1;
+  tally_mask_t bit = (tally_mask_t)1 << (camera % TALLY_MASK_BITS);
+  uint8_t w = camera / TALLY_MASK_BITS;
+  bool found = false;
+  for (uint8_t i = 0; i < _source_count; i++) {
+    found |= _sources[i] == source;
+  }
+  if (!found) {
+    return false;
+  }
+  for (uint8_t i = 0; i < _source_count; i++) {
+    _source_cameras[i][w] = _sources[i] == source
+                                ? (_source_cameras[i][w] | bit)
+                                : (_source_cameras[i][w] & ~bit);
+  }
+  return true;
 }
 
-void Tally::HandleDataFromAtem() {
-  for (uint8_t tally_number = 1; tally_number <= MAX_TALLY; tally_number++) {
-    bool program_tally = _atem_switcher.getProgramTally(tally_number);
-    bool preview_tally = _atem_switcher.getPreviewTally(tally_number);
-
-    if ((_program_tally_previous[tally_number - 1] != program_tally) ||
-        (_preview_tally_previous[tally_number - 1] !=
-         preview_tally)) {  // changed?
-      if ((program_tally && !preview_tally) ||
-          (program_tally &&
-           preview_tally)) {  // only program, or program AND preview
-        _camera_status[tally_number - 1] = 0x32;      // red
-      } else if (preview_tally && !program_tally) {   // only preview
-        _camera_status[tally_number - 1] = 0x31;      // green
-      } else if (!preview_tally || !program_tally) {  // neither
-        _camera_status[tally_number - 1] = 0x30;      // black
-      }
+void Tally::InitConnectionWithServerSide() {
+  if (_run_all) {
+    for (uint8_t i = 0; i < _source_count; i++) {
+      Log.notice("source %s" CR, _sources[i]->Name());
+      _sources[i]->Begin();
     }
-
-    _program_tally_previous[tally_number - 1] = program_tally;
-    _preview_tally_previous[tally_number - 1] = preview_tally;
+    return;
   }
+  if (!_active) {
+    Log.error("no tally source" CR);
+    return;
+  }
+  Log.notice("source %s" CR, _active->Name());
+  _active->Begin();
 }
 
 /**
- * @brief handle data from ROLAND
- *  stxQPL:b;
- *  Response command parameters
- *    when a=0, b: 0 (CH 1)–3 (CH 4) PGM
- *    When a=1, b: 0 (CH 1)–3 (CH 4) PST
- *    When a=2, b: 0 (OFF), 1 (ON) [PinP] button
- *    When a=3, b: 0 (OFF), 1 (ON) [SPLIT] button
- *    When a=4, b: 0 (OFF), 1 (ON) [DSK] button
- *    When a=5, b: 0 (WIPE), 1 (MIX), 2 (CUT) TRANSITION buttons
- *    When a=6, b: 0–255 Output fade level
- *                 0: black, 255: white, 128: center
- *    When a=7, b: 0–255 Output level of A/B fader
- *                 0: bus B end, 255: bus A end, 128: center
- *    When a=8, sends all information described above.
- *    Example: stxQPL:0,1,0,1,1,0,100,255;
+ * @brief run the active source once, or every source and merge them, and
+ *  render the cameras that changed
+ *  A change is reported once, however many sources it came from.
  *
- * @param response
+ * @return bit per tally group whose camera status changed since the previous
+ *  call, 0 if none; read the status with CameraStatus(group)
  */
-void Tally::HandleDataFromRoland(String response) {
-  // stxQPL:
-  const char roland_tally_rsp[] = {0x02, 0x51, 0x50, 0x4C, 0x3A};
-  const uint8_t len = strlen(roland_tally_rsp);
-  const char* content_rsp = response.c_str();
-  // verify if response status of operation-panel buttons
-  if (!strncmp(response.c_str(), roland_tally_rsp, len)) {
-    char* pch;
-    uint8_t infor_tally[MAXPARAM] = {0};
-    uint8_t i = 0;
-    // split each number via ',;' character delimiter
-    pch = strtok(content_rsp + len, ",;");
-    while (pch != nullptr && i < MAXPARAM) {
-      infor_tally[i] = atoi(pch);
-      Log.notice("%d" CR, infor_tally[i]);
-      i++;
-      pch = strtok(nullptr, ",;");
+uint8_t Tally::ProcessTally() {
+  if (_run_all) {
+    for (uint8_t i = 0; i < _source_count; i++) {
+      _sources[i]->Poll();
+    }
+    MergeSources();
+  } else if (_active) {
+    _active->Poll();
+  }
+  uint8_t changed_groups = CommitTally();
+  for (uint8_t group = 0; group < TALLY_GROUPS; group++) {
+    if ((changed_groups >> group) & 1) {
+      DumpStatusCamera(group);
     }
-    // set all status tally to off
-    memset(_camera_status, '0', MAX_TALLY);
-    // assign PGM LED and PST LED
-    _camera_status[infor_tally[PGM]] = 0x32;  // red
-    _camera_status[infor_tally[PST]] = 0x31;  // green
-    DumpStatusCamera();
   }
+  return changed_groups;
 }
 
 /**
- * @brief dump status of each tally, using for test purpose
- *
+ * @brief merge the tally of the sources that are up into _program/_preview,
+ *  a word of cameras at a time
+ *  MERGE_OR lights a camera the way any source does, program first.
+ *  MERGE_PRIORITY gives each camera to the first source that lights it at
+ *  all. Either way a source only reaches the cameras AssignCamera() left it.
  */
-void Tally::DumpStatusCamera() {
-  Log.notice("status camera" CR);
-  for (uint8_t i = 0; i < MAX_TALLY; i++) {
-    Log.notice("%d" CR, _camera_status[i]);
+void Tally::MergeSources() {
+  memset(_program, 0, sizeof(_program));
+  memset(_preview, 0, sizeof(_preview));
+  for (uint8_t group = 0; group < TALLY_GROUPS; group++) {
+    for (uint8_t w = 0; w < TALLY_MASK_WORDS; w++) {
+      // cameras a higher priority source has lit already
+      tally_mask_t taken = 0;
+      for (uint8_t i = 0; i < _source_count; i++) {
+        if (_sources[i]->Health() != SOURCE_UP) {
+          continue;
+        }
+        tally_mask_t allowed = _source_cameras[i][w];
+        if (_merge == MERGE_PRIORITY) {
+          allowed &= ~taken;
+        }
+        tally_mask_t program = _sources[i]->Program(group)[w] & allowed;
+        tally_mask_t preview = _sources[i]->Preview(group)[w] & allowed;
+        _program[group][w] |= program;
+        _preview[group][w] |= preview;
+        taken |= program | preview;
+      }
+    }
   }
 }
 
-void Tally::InitConnectionWithServerSide() {
-  switch (_tally_type) {
-    case VMIX:
-      InitVmix();
-      break;
-    case ATEM:
-      InitAtem();
-      break;
-    case ROLAND:
-      InitRoland();
-      break;
-    default:
-      Log.error("device not support (%d)" CR, _tally_type);
-      break;
+/**
+ * @brief compare the tally of the active source, or the merged one, with
+ *  what was last reported, one XOR per word, and re-render the status of
+ *  the cameras that changed
+ *
+ * @return bit per tally group that changed since the previous call
+ */
+uint8_t Tally::CommitTally() {
+  if (!_run_all && !_active) {
+    return 0;
   }
+  uint8_t changed_groups = 0;
+  for (uint8_t group = 0; group < TALLY_GROUPS; group++) {
+    const tally_mask_t* program =
+        _run_all ? _program[group] : _active->Program(group);
+    const tally_mask_t* preview =
+        _run_all ? _preview[group] : _active->Preview(group);
+    for (uint8_t w = 0; w < TALLY_MASK_WORDS; w++) {
+      tally_mask_t changed = (program[w] ^ _program_reported[group][w]) |
+                             (preview[w] ^ _preview_reported[group][w]);
+      if (!changed) {
+        continue;
+      }
+      for (uint8_t bit = 0; changed; bit++, changed >>= 1) {
+        if (changed & 1) {
+          uint8_t camera = w * TALLY_MASK_BITS + bit;
+          // program (with or without preview) wins over preview
+          if ((program[w] >> bit) & 1) {
+            _camera_status[group][camera] = STATUS_PROGRAM;
+          } else if ((preview[w] >> bit) & 1) {
+            _camera_status[group][camera] = STATUS_PREVIEW;
+          } else {
+            _camera_status[group][camera] = STATUS_OFF;
+          }
+        }
+      }
+      _program_reported[group][w] = program[w];
+      _preview_reported[group][w] = preview[w];
+      changed_groups |= 1 << group;
+    }
+  }
+  return changed_groups;
 }
 
-void Tally::InitVmix() {
-  ConnectToVmix();
-  _client.println("SUBSCRIBE TALLY");
-}
-
-void Tally::InitAtem() {
-  // Initialize a connection to the switcher
-  _atem_switcher.begin(_atem_server);
-  // set to 0x80 to enable debug
-  _atem_switcher.serialOutput(0);
-  _atem_switcher.connect();
-}
-
-static void Tally::TimerIsr() {
-  // request to ROLAND->stxQPL : 8;
-  const char roland_request[] = {0x02, 0x51, 0x50, 0x4C, 0x3A, 0x38, 0x3B};
-  _roland.println(roland_request);
-}
-
-void Tally::InitRoland() {
-  _roland.begin(9600);
-  Timer1.initialize(300000);
-  Timer1.attachInterrupt(TimerIsr);
-  Timer1.start();
+/**
+ * @brief log when a source comes up or goes down; the sources reconnect by
+ *  themselves from Poll()
+ */
+void Tally::CheckConnection() {
+  for (uint8_t i = 0; i < _source_count; i++) {
+    SOURCE_HEALTH health = _sources[i]->Health();
+    if (health == _health[i]) {
+      continue;
+    }
+    _health[i] = health;
+    switch (health) {
+      case SOURCE_UP:
+        Log.notice("%s up" CR, _sources[i]->Name());
+        break;
+      case SOURCE_CONNECTING:
+        Log.warning("%s connecting" CR, _sources[i]->Name());
+        break;
+      case SOURCE_DOWN:
+      default:
+        Log.warning("%s down" CR, _sources[i]->Name());
+        break;
+    }
+  }
 }
 
-void Tally::InitSwitchInput() {
-  pinMode(ATEM, INPUT);
-  pinMode(VMIX, INPUT);
-  pinMode(ROLAND, INPUT);
+/**
+ * @brief dump status of each tally, using for test purpose
+ *
+ */
+void Tally::DumpStatusCamera(uint8_t group) {
+  Log.notice("status camera, group %d" CR, group);
+  for (uint8_t i = 0; i < MAX_TALLY; i++) {
+    Log.notice("%d" CR, _camera_status[group][i]);
+  }
 }
 
+/**
+ * @brief follow the device switch: the source being left gives back its
+ *  sockets and serial port before the selected one connects
+ *  The pins are read every DEVICE_SCAN_MS rather than every loop(), and a
+ *  new position must hold for DEVICE_DEBOUNCE_MS, so a bouncing contact or
+ *  a rotary switch passing over other positions does not connect each
+ *  source on the way. With no position selected the active source stays.
+ */
 void Tally::HandleSwitchDevice() {
-  uint8_t device[] = {ATEM, VMIX, ROLAND};
-  for (uint8_t i = 0; i < ARRAY_SIZE(device); i++) {
-    if (!digitalRead(device[i])) {
-      if (_tally_type != device[i]) {
-        _tally_type = device[i];
-        InitConnectionWithServerSide();
-      }
+  unsigned long now = millis();
+  if (_run_all || now - _scanned_at < DEVICE_SCAN_MS) {
+    return;
+  }
+  _scanned_at = now;
+  uint8_t selected = NO_SOURCE;
+  for (uint8_t i = 0; i < _source_count; i++) {
+    if (!digitalRead(_source_pins[i])) {
+      selected = i;
       break;
     }
   }
-  if (_tally_type != ROLAND) {
-    Timer1.stop();
+  if (selected != _selected) {
+    _selected = selected;
+    _selected_at = now;
+    return;
+  }
+  if (selected == NO_SOURCE || _active == _sources[selected] ||
+      now - _selected_at < DEVICE_DEBOUNCE_MS) {
+    return;
   }
+  if (_active) {
+    _active->Teardown();
+  }
+  _active = _sources[selected];
+  InitConnectionWithServerSide();
 }
 
-void Tally::ConnectToVmix() {
-  while (!_client.connect(_vmix_server, _port_vmix)) {
-    delay(1000);
-    Log.notice("." CR);
+/**
+ * @brief cameras the RF frames carry: those of the active source, or the
+ *  most any source reports when running them all
+ */
+uint8_t Tally::CameraCount() {
+  if (!_run_all) {
+    return _active ? _active->Cameras() : MAX_TALLY;
+  }
+  uint8_t cameras = 0;
+  for (uint8_t i = 0; i < _source_count; i++) {
+    if (_sources[i]->Cameras() > cameras) {
+      cameras = _sources[i]->Cameras();
+    }
   }
-  Log.notice("connected Vmix" CR);
+  return cameras;
 }
@@ -1,81 +1,101 @@
 #ifndef TALLY_h
 #define TALLY_h
 
-#include <ATEMbase.h>
-#include <ATEMstd.h>
 #include <ArduinoLog.h>
 #include <Ethernet.h>
 #include <SPI.h>
-#include <SoftwareSerial.h>
-#include <TimerOne.h>
+
+#include "tally_source.h"
 
 #define ARRAY_SIZE(variable) (*(&variable + 1) - variable)
 
 // define for pin number of switch
 typedef enum device { ATEM = 3, VMIX = 4, ROLAND = 5 } TALLY_TYPE;
 
-#define MAX_TALLY 8
-#define rolandTX 6
-#define rolandRX 7
+// sources registered with Tally::AddSource, one per switch position and
+// protocol built in (tally_config.h)
+#ifndef MAX_TALLY_SOURCES
+#define MAX_TALLY_SOURCES (TALLY_ATEM + TALLY_VMIX + TALLY_ROLAND)
+#endif
+
+// camera status characters sent over RF
+#define STATUS_OFF 0x30      // black
+#define STATUS_PREVIEW 0x31  // green
+#define STATUS_PROGRAM 0x32  // red
+
 #define CS_SPI 10
 #define DEVICE_DEFAULT ATEM
+// the device switch is sampled every DEVICE_SCAN_MS, and a new position is
+// taken once it has held for DEVICE_DEBOUNCE_MS
+#define DEVICE_SCAN_MS 10
+#ifndef DEVICE_DEBOUNCE_MS
+#define DEVICE_DEBOUNCE_MS 50
+#endif
+#define NO_SOURCE 0xFF
 
-typedef enum rolandTallyParam {
-  PGM,
-  PST,
-  PinP,
-  SPLIT,
-  DSK,
-  TRANSITION,
-  FADE,
-  FADER,
-  MAXPARAM
-} ROLAND_PARAM;
+// how Tally::RunAllSources combines cameras lit by several sources
+typedef enum mergePolicy {
+  MERGE_OR,       // program if any source has it on program, else preview
+  MERGE_PRIORITY  // the first source added that lights the camera decides
+} MERGE_POLICY;
 
+/**
+ * @brief Ethernet, the device switch, and the camera status of the active
+ *  TallySource, or of all of them merged (RunAllSources); the protocols
+ *  themselves live in the sources
+ */
 class Tally {
  private:
   // MAC address must be unique in LAN
   byte _mac[6];
   IPAddress _ip;
 
-  ATEMstd _atem_switcher;
-  EthernetClient _client;
-
-  IPAddress _vmix_server;
-  IPAddress _atem_server;
-  uint16_t _port_vmix = 8099;  // Vmix fixed port 8099
-
-  TALLY_TYPE _tally_type = DEVICE_DEFAULT;
+  // registered sources and the switch pin that selects each
+  TallySource* _sources[MAX_TALLY_SOURCES];
+  uint8_t _source_pins[MAX_TALLY_SOURCES];
+  uint8_t _source_count = 0;
+  TallySource* _active = nullptr;
+  // switch position (source index) last sampled, and since when
+  uint8_t _selected = NO_SOURCE;
+  unsigned long _selected_at = 0;
+  unsigned long _scanned_at = 0;
+  SOURCE_HEALTH _health[MAX_TALLY_SOURCES] = {SOURCE_DOWN};
+  // all sources at once, the device switch is ignored
+  bool _run_all = false;
+  MERGE_POLICY _merge = MERGE_OR;
+  // cameras each source may light, all of them unless AssignCamera()
+  tally_mask_t _source_cameras[MAX_TALLY_SOURCES][TALLY_MASK_WORDS];
 
-  uint8_t _camera_status[MAX_TALLY] = {0};
-  uint8_t _previous_roland[4] = {0};
-  bool _preview_tally_previous[MAX_TALLY] = {true};
-  bool _program_tally_previous[MAX_TALLY] = {true};
+  // merged tally of all sources when running them all
+  tally_mask_t _program[TALLY_GROUPS][TALLY_MASK_WORDS] = {{0}};
+  tally_mask_t _preview[TALLY_GROUPS][TALLY_MASK_WORDS] = {{0}};
+  // tally of the active source as last reported by ProcessTally
+  tally_mask_t _program_reported[TALLY_GROUPS][TALLY_MASK_WORDS] = {{0}};
+  tally_mask_t _preview_reported[TALLY_GROUPS][TALLY_MASK_WORDS] = {{0}};
+  // status character per camera, rendered from the masks for RF
+  uint8_t _camera_status[TALLY_GROUPS][MAX_TALLY];
 
   Tally();
-  bool HandleDataFromVmix(String data);
-  void HandleDataFromAtem();
-  void HandleDataFromRoland(String data);
-  void ConnectToVmix();
-  void InitVmix();
-  void InitAtem();
-  void InitRoland();
-  void InitSwitchInput();
-  void DumpStatusCamera();
-  static void TimerIsr();
+  void MergeSources();
+  uint8_t CommitTally();
+  void DumpStatusCamera(uint8_t group);
 
   static Tally* m_instance;
-  static SoftwareSerial _roland;
 
  public:
   static Tally* Instance();
 
   void Begin();
+  bool AddSource(TallySource* source, uint8_t select_pin);
+  void RunAllSources(MERGE_POLICY policy);
+  bool AssignCamera(uint8_t tally_number, TallySource* source);
   void InitConnectionWithServerSide();
-  uint8_t* ProcessTally();
+  uint8_t ProcessTally();
+  uint8_t* CameraStatus(uint8_t group) { return _camera_status[group]; }
   void CheckConnection();
   void HandleSwitchDevice();
-  TALLY_TYPE WhichDevice() { return _tally_type; }
+  TallySource* ActiveSource() { return _active; }
+  uint8_t CameraCount();
 };
 
-#endif
\ No newline at end of file
+#endif
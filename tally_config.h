@@ -0,0 +1,26 @@
+#ifndef TALLY_CONFIG_h
+#define TALLY_CONFIG_h
+
+// Switcher protocols built into the transmitter. Set the ones not needed to
+// 0 here (or with -D) and their driver, state and libraries are left out:
+// without ATEM no ATEMstd, without ROLAND no second SoftwareSerial.
+#ifndef TALLY_ATEM
+#define TALLY_ATEM 1
+#endif
+#ifndef TALLY_VMIX
+#define TALLY_VMIX 1
+#endif
+#ifndef TALLY_ROLAND
+#define TALLY_ROLAND 1
+#endif
+
+// ATEM client: the tally-only ATEMtally by default, 1 for the full ATEMstd
+#ifndef TALLY_ATEM_STD
+#define TALLY_ATEM_STD 0
+#endif
+
+#if !TALLY_ATEM && !TALLY_VMIX && !TALLY_ROLAND
+#error "enable at least one of TALLY_ATEM, TALLY_VMIX and TALLY_ROLAND"
+#endif
+
+#endif
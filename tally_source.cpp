@@ -0,0 +1,91 @@
+#include "tally_source.h"
+
+/**
+ * @brief set program/preview tally of one camera in the packed store
+ *
+ * @param group tally group, 0 for drivers without M/E routing
+ * @param camera 0-based camera index, ignored if >= MAX_TALLY
+ */
+void TallySource::SetCamera(uint8_t group, uint8_t camera, bool program,
+                            bool preview) {
+  if (camera >= MAX_TALLY) {
+    return;
+  }
+  tally_mask_t bit = (tally_mask_t)1 << (camera % TALLY_MASK_BITS);
+  uint8_t w = camera / TALLY_MASK_BITS;
+  tally_mask_t* pgm = &_program[group][w];
+  tally_mask_t* pvw = &_preview[group][w];
+  *pgm = program ? (*pgm | bit) : (*pgm & ~bit);
+  *pvw = preview ? (*pvw | bit) : (*pvw & ~bit);
+}
+
+void TallySource::ClearCameras() {
+  memset(_program, 0, sizeof(_program));
+  memset(_preview, 0, sizeof(_preview));
+}
+
+void SourceClient::Begin() {
+  // connect() and stop() of the W5100 library block for up to this long
+  _client.setConnectionTimeout(CLIENT_LOOP_BUDGET_MS);
+  _client.stop();
+  _backoff_ms = CLIENT_BACKOFF_MIN_MS;
+  _state = CLIENT_CONNECTING;
+}
+
+// wait out the backoff, and double it for the next failure
+void SourceClient::Retry() {
+  _retry_at = millis() + _backoff_ms;
+  _backoff_ms = _backoff_ms < CLIENT_BACKOFF_MAX_MS / 2 ? _backoff_ms * 2
+                                                        : CLIENT_BACKOFF_MAX_MS;
+  _state = CLIENT_FAILED;
+}
+
+bool SourceClient::Advance() {
+  switch (_state) {
+    case CLIENT_SUBSCRIBED:
+      if (_client.connected()) {
+        break;
+      }
+      _client.stop();
+      Log.notice("disconnected %s, retry in %d ms" CR, _name, _backoff_ms);
+      Retry();
+      break;
+    case CLIENT_FAILED:
+      if ((long)(millis() - _retry_at) < 0) {
+        break;
+      }
+      _state = CLIENT_CONNECTING;
+      break;
+    case CLIENT_CONNECTING:
+      if (_client.connect(_server, _port)) {
+        Log.notice("connected %s" CR, _name);
+        _state = CLIENT_SUBSCRIBED;
+        return true;
+      }
+      Log.notice("%s not reachable, retry in %d ms" CR, _name, _backoff_ms);
+      Retry();
+      break;
+    case CLIENT_IDLE:
+    default:
+      break;
+  }
+  return false;
+}
+
+void SourceClient::Stop() {
+  _client.stop();
+  _state = CLIENT_IDLE;
+}
+
+SOURCE_HEALTH SourceClient::Health() const {
+  switch (_state) {
+    case CLIENT_SUBSCRIBED:
+      return SOURCE_UP;
+    case CLIENT_CONNECTING:
+    case CLIENT_FAILED:
+      return SOURCE_CONNECTING;
+    case CLIENT_IDLE:
+    default:
+      return SOURCE_DOWN;
+  }
+}
@@ -0,0 +1,133 @@
+#ifndef TALLY_SOURCE_h
+#define TALLY_SOURCE_h
+
+#include <Arduino.h>
+#include <ArduinoLog.h>
+#include <Ethernet.h>
+
+#include "tally_config.h"
+
+// number of cameras, override with -DMAX_TALLY=n (ATEM needs
+// ATEM_maxTallySources >= MAX_TALLY)
+#ifndef MAX_TALLY
+#define MAX_TALLY 8
+#endif
+
+// packed tally state: one bit per camera, camera n in word n / 8, bit n % 8
+typedef uint8_t tally_mask_t;
+#define TALLY_MASK_BITS 8
+#define TALLY_MASK_WORDS ((MAX_TALLY + TALLY_MASK_BITS - 1) / TALLY_MASK_BITS)
+
+// tally groups, each sent as its own RF frame (TallyFrame group); group 0
+// carries the switcher's own tally, override with -DTALLY_GROUPS=n
+#ifndef TALLY_GROUPS
+#define TALLY_GROUPS 1
+#endif
+#if TALLY_GROUPS > 8
+#error "TALLY_GROUPS must fit the changed-group mask returned by ProcessTally"
+#endif
+
+// what Tally can expect of a source
+typedef enum sourceHealth {
+  SOURCE_DOWN,        // not started, or torn down
+  SOURCE_CONNECTING,  // started, the device has not answered (yet, again)
+  SOURCE_UP           // the device answers, its tally is current
+} SOURCE_HEALTH;
+
+/**
+ * @brief one switcher protocol feeding Tally
+ *
+ * A source owns its connection and parser state, and writes the tally it
+ * decodes into its own packed program/preview masks with SetCamera(). Tally
+ * reads the masks back after each Poll(), so it only ever deals with this
+ * interface: new drivers, simulated switchers in benchmarks, or any set of
+ * them can be run without touching the core.
+ *
+ * Begin() starts from no tally and may be called again after Teardown().
+ * Poll() must return without blocking loop() for more than a few ms.
+ */
+class TallySource {
+ protected:
+  tally_mask_t _program[TALLY_GROUPS][TALLY_MASK_WORDS] = {{0}};
+  tally_mask_t _preview[TALLY_GROUPS][TALLY_MASK_WORDS] = {{0}};
+
+  void SetCamera(uint8_t group, uint8_t camera, bool program, bool preview);
+  void ClearCameras();
+
+ public:
+  // connect to the device, from no tally
+  virtual void Begin() = 0;
+  // read what the device sent and keep the connection alive, once per loop()
+  virtual void Poll() = 0;
+  // give back the sockets and serial port Begin() took
+  virtual void Teardown() = 0;
+  virtual SOURCE_HEALTH Health() = 0;
+  // for the logs
+  virtual const char* Name() = 0;
+  // cameras the device reports, RF frames carry this many
+  virtual uint8_t Cameras() { return MAX_TALLY; }
+
+  const tally_mask_t* Program(uint8_t group) const { return _program[group]; }
+  const tally_mask_t* Preview(uint8_t group) const { return _preview[group]; }
+};
+
+// TCP connection to vMix or a Roland on LAN, advanced from Poll() without
+// blocking the loop; SUBSCRIBED is connected with the status requested
+// (vMix SUBSCRIBE, Roland polling)
+typedef enum clientState {
+  CLIENT_IDLE,
+  CLIENT_CONNECTING,
+  CLIENT_SUBSCRIBED,
+  CLIENT_FAILED
+} CLIENT_STATE;
+
+// longest loop() may block on a connect attempt, and the retry backoff after
+// a failed attempt or a dropped connection, doubled up to the maximum
+#ifndef CLIENT_LOOP_BUDGET_MS
+#define CLIENT_LOOP_BUDGET_MS 100
+#endif
+#define CLIENT_BACKOFF_MIN_MS 500
+#define CLIENT_BACKOFF_MAX_MS 16000
+
+/**
+ * @brief the TCP client of a source, with reconnect and backoff
+ *  IDLE -> CONNECTING -> SUBSCRIBED, and on a failed attempt or a dropped
+ *  connection FAILED -> (backoff) -> CONNECTING. A connect attempt blocks
+ *  for at most CLIENT_LOOP_BUDGET_MS, every other step returns at once.
+ *  The backoff only starts over once the device answered (Answered()), so
+ *  a server that accepts and drops the connection is not hammered either.
+ */
+class SourceClient {
+ private:
+  EthernetClient _client;
+  const char* _name;
+  IPAddress _server;
+  uint16_t _port;
+  CLIENT_STATE _state = CLIENT_IDLE;
+  uint16_t _backoff_ms = CLIENT_BACKOFF_MIN_MS;
+  unsigned long _retry_at = 0;
+
+  void Retry();
+
+ public:
+  SourceClient(const char* name, IPAddress server, uint16_t port)
+      : _name(name), _server(server), _port(port) {}
+
+  // (re)start the connection from scratch
+  void Begin();
+  /**
+   * @brief one step of the connection
+   * @return true right after it connected: the caller subscribes, and
+   *  starts its parser over
+   */
+  bool Advance();
+  // the source received a complete line or frame on this connection
+  void Answered() { _backoff_ms = CLIENT_BACKOFF_MIN_MS; }
+  void Stop();
+
+  CLIENT_STATE State() const { return _state; }
+  SOURCE_HEALTH Health() const;
+  EthernetClient& Client() { return _client; }
+};
+
+#endif
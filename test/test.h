@@ -0,0 +1,52 @@
+/**
+ * Minimal checks for the host tests in test/: each test is an executable
+ * registered with CTest that returns non-zero if any CHECK failed.
+ */
+#ifndef TEST_TEST_h
+#define TEST_TEST_h
+
+#include <stdio.h>
+
+namespace test {
+
+inline int& Failures() {
+  static int failures = 0;
+  return failures;
+}
+
+inline void Check(bool ok, const char* expression, const char* file,
+                  int line) {
+  if (!ok) {
+    fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+    Failures()++;
+  }
+}
+
+inline void CheckEqual(long actual, long expected, const char* expression,
+                       const char* file, int line) {
+  if (actual != expected) {
+    fprintf(stderr, "%s:%d: %s is %ld, expected %ld\n", file, line,
+            expression, actual, expected);
+    Failures()++;
+  }
+}
+
+// prints the result, returns the exit code for main()
+inline int Result(const char* name) {
+  if (Failures()) {
+    fprintf(stderr, "%s: %d check(s) failed\n", name, Failures());
+    return 1;
+  }
+  printf("%s: ok\n", name);
+  return 0;
+}
+
+}  // namespace test
+
+#define CHECK(expression) \
+  test::Check((expression), #expression, __FILE__, __LINE__)
+#define CHECK_EQ(actual, expected)                                    \
+  test::CheckEqual((long)(actual), (long)(expected), #actual, __FILE__, \
+                   __LINE__)
+
+#endif
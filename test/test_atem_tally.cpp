@@ -0,0 +1,164 @@
+/**
+ * TlIn (tally by index) parsing of ATEMstd and ATEMtally with more sources
+ * than ATEM_maxTallySources: the flags stored, the count reported, the bytes
+ * past the stored ones skipped, and the generation counter. TlSr (tally by
+ * source) goes through the same shared ATEMbase parser in both clients.
+ *
+ * usage: test_atem_tally
+ */
+#include <vector>
+
+#include "ATEMtally.h"
+#include "atem_dump.h"
+#include "test.h"
+
+namespace {
+
+const uint8_t kProgramSource = 7;
+
+template <class Client>
+class TestClient : public Client {
+ public:
+  void Listen(uint16_t port) {
+    this->begin(IPAddress(127, 0, 0, 1));
+    this->_Udp.begin(port);
+  }
+
+  void ParseOne() {
+    int size = this->_Udp.parsePacket();
+    CHECK(size > 12);
+    if (size <= 12) return;
+    this->_Udp.read(this->_packetBuffer, 12);
+    this->_parsePacket(size);
+  }
+};
+
+void AddCommand(bench::Packet* packet, const char* name,
+                const std::vector<uint8_t>& body) {
+  uint16_t length = 8 + body.size();
+  uint8_t header[8] = {(uint8_t)(length >> 8), (uint8_t)length, 0, 0,
+                       (uint8_t)name[0],       (uint8_t)name[1],
+                       (uint8_t)name[2],       (uint8_t)name[3]};
+  packet->insert(packet->end(), header, header + 8);
+  packet->insert(packet->end(), body.begin(), body.end());
+}
+
+// TlIn with the given flags, then PrgI, which is only parsed right if every
+// TlIn byte was read or skipped
+bench::Packet TallyPacket(const std::vector<uint8_t>& flags) {
+  bench::Packet packet(12, 0);
+  std::vector<uint8_t> tally(2, 0);
+  tally[0] = flags.size() >> 8;
+  tally[1] = flags.size() & 0xFF;
+  tally.insert(tally.end(), flags.begin(), flags.end());
+  tally.resize((tally.size() + 3) & ~3, 0);
+  AddCommand(&packet, "TlIn", tally);
+  AddCommand(&packet, "PrgI", {0, 0, 0, kProgramSource});
+  packet[0] = (packet.size() >> 8) & 0x07;
+  packet[1] = packet.size() & 0xFF;
+  return packet;
+}
+
+bench::Packet SourcePacket(const std::vector<uint16_t>& sources,
+                           const std::vector<uint8_t>& flags) {
+  bench::Packet packet(12, 0);
+  std::vector<uint8_t> tally(2, 0);
+  tally[1] = sources.size();
+  for (size_t i = 0; i < sources.size(); i++) {
+    tally.push_back(sources[i] >> 8);
+    tally.push_back(sources[i] & 0xFF);
+    tally.push_back(flags[i]);
+  }
+  tally.resize((tally.size() + 3) & ~3, 0);
+  AddCommand(&packet, "TlSr", tally);
+  packet[0] = (packet.size() >> 8) & 0x07;
+  packet[1] = packet.size() & 0xFF;
+  return packet;
+}
+
+template <class Client>
+void RunBySource(uint16_t port) {
+  TestClient<Client> client;
+  client.Listen(port);
+  bench::UdpFeeder feeder(port);
+
+  // 9999 is not in the getVideoSrcIndex() table and is ignored
+  feeder.Send(SourcePacket({1, 2, 9999, 1000}, {1, 2, 3, 3}));
+  client.ParseOne();
+  CHECK_EQ(client.getTallyBySourceTallyFlags(1), 1);
+  CHECK_EQ(client.getTallyBySourceTallyFlags(2), 2);
+  CHECK_EQ(client.getTallyBySourceTallyFlags(3), 0);
+  CHECK_EQ(client.getTallyBySourceTallyFlags(1000), 3);
+  CHECK_EQ(client.getTallyBySourceGeneration(), 1);
+
+  feeder.Send(SourcePacket({1, 2}, {1, 2}));
+  client.ParseOne();
+  CHECK_EQ(client.getTallyBySourceGeneration(), 1);
+  feeder.Send(SourcePacket({1, 2}, {0, 2}));
+  client.ParseOne();
+  CHECK_EQ(client.getTallyBySourceTallyFlags(1), 0);
+  CHECK_EQ(client.getTallyBySourceGeneration(), 2);
+  client.disconnect();
+}
+
+template <class Client>
+void Run(uint16_t sources, uint16_t port) {
+  TestClient<Client> client;
+  client.Listen(port);
+  bench::UdpFeeder feeder(port);
+  uint16_t stored =
+      sources < ATEM_maxTallySources ? sources : ATEM_maxTallySources;
+
+  std::vector<uint8_t> flags(sources);
+  for (uint16_t s = 0; s < sources; s++) flags[s] = (s % 3) + 1;
+  feeder.Send(TallyPacket(flags));
+  client.ParseOne();
+  CHECK_EQ(client.getTallyByIndexSources(), sources);
+  for (uint16_t s = 0; s < stored; s++) {
+    CHECK_EQ(client.getTallyByIndexTallyFlags(s), flags[s]);
+    CHECK(client.getTallyByIndexChanged(s));
+  }
+  CHECK_EQ(client.getProgramInputVideoSource(0), kProgramSource);
+  uint8_t generation = client.getTallyByIndexGeneration();
+  CHECK_EQ(generation, 1);
+
+  // the same flags again: nothing changed
+  client.clearTallyByIndexChanged();
+  feeder.Send(TallyPacket(flags));
+  client.ParseOne();
+  CHECK_EQ(client.getTallyByIndexGeneration(), generation);
+  for (uint16_t s = 0; s < stored; s++) {
+    CHECK(!client.getTallyByIndexChanged(s));
+  }
+
+  // a change past the stored sources is not seen
+  if (sources > stored) {
+    flags[stored] ^= 0x03;
+    feeder.Send(TallyPacket(flags));
+    client.ParseOne();
+    CHECK_EQ(client.getTallyByIndexGeneration(), generation);
+  }
+
+  // the last stored source changes
+  flags[stored - 1] = 0;
+  feeder.Send(TallyPacket(flags));
+  client.ParseOne();
+  CHECK_EQ(client.getTallyByIndexGeneration(), generation + 1);
+  CHECK_EQ(client.getTallyByIndexTallyFlags(stored - 1), 0);
+  CHECK(client.getTallyByIndexChanged(stored - 1));
+  CHECK(stored < 2 || !client.getTallyByIndexChanged(stored - 2));
+  client.disconnect();
+}
+
+}  // namespace
+
+int main() {
+  printf("ATEM_maxTallySources %d\n", ATEM_maxTallySources);
+  Run<ATEMstd>(40, 50990);
+  Run<ATEMstd>(200, 50991);
+  Run<ATEMtally>(40, 50992);
+  Run<ATEMtally>(200, 50993);
+  RunBySource<ATEMstd>(50994);
+  RunBySource<ATEMtally>(50995);
+  return test::Result("test_atem_tally");
+}
@@ -0,0 +1,77 @@
+/**
+ * Helpers for the host tests of sources that connect over TCP: the manual
+ * clock they run on, and a loopback server for the source to connect to.
+ */
+#ifndef TEST_TEST_NET_h
+#define TEST_TEST_NET_h
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include "hal.h"
+#include "tally_source.h"
+#include "test.h"
+
+namespace test {
+
+/**
+ * @brief the clock of millis() and delay(), installed on first use and
+ *  started well past 0
+ */
+inline hal::ManualClock& Clock() {
+  static hal::ManualClock clock;
+  static bool installed = false;
+  if (!installed) {
+    hal::SetClock(&clock);
+    clock.Advance(1000000);
+    installed = true;
+  }
+  return clock;
+}
+
+/**
+ * @return a non-blocking socket listening on 127.0.0.1:port
+ */
+inline int ListenLoopback(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  CHECK(!bind(fd, (struct sockaddr*)&addr, sizeof(addr)));
+  CHECK(!listen(fd, 4));
+  return fd;
+}
+
+/**
+ * @brief calls poll() a millisecond apart until the source has connected,
+ *  for at most CLIENT_BACKOFF_MAX_MS
+ * @return the server end, non-blocking and without Nagle like the W5100,
+ *  or -1
+ */
+template <typename Poll>
+int AcceptWhilePolling(Poll poll, int server) {
+  for (int ms = 0; ms <= CLIENT_BACKOFF_MAX_MS; ms++) {
+    poll();
+    int fd = accept4(server, nullptr, nullptr, SOCK_NONBLOCK);
+    if (fd >= 0) {
+      int on = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+      return fd;
+    }
+    CHECK(errno == EAGAIN || errno == EWOULDBLOCK);
+    Clock().Advance(1000);
+  }
+  CHECK(false);
+  return -1;
+}
+
+}  // namespace test
+
+#endif
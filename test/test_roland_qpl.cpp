@@ -0,0 +1,149 @@
+/**
+ * RolandQplParser fed from a SoftwareSerial pty, the way RolandSource reads
+ * the V-1HD: whole, fragmented and noisy stxQPL frames written to the slave
+ * side and decoded from whatever available() returns per call.
+ *
+ * usage: test_roland_qpl
+ */
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "SoftwareSerial.h"
+#include "hal.h"
+#include "roland_protocol.h"
+#include "test.h"
+
+namespace {
+
+const char kStx[] = "\x02";
+const char kAck[] = "\x06";
+
+class Wire {
+ private:
+  SoftwareSerial _port;
+  int _switcher = -1;  // the V-1HD end of the pty
+  RolandQplParser _qpl;
+  // the last complete frame, as RolandSource::HandleData() would see it
+  uint8_t _params[MAXPARAM] = {0};
+  uint8_t _count = 0;
+
+ public:
+  int frames = 0;
+
+  Wire() : _port(7, 6) {
+    _port.begin(9600);
+    _switcher = open(_port.portName(), O_RDWR | O_NOCTTY);
+    CHECK(_switcher >= 0);
+  }
+  ~Wire() {
+    if (_switcher >= 0) close(_switcher);
+    _port.end();
+  }
+
+  uint8_t Param(ROLAND_PARAM param) const { return _params[param]; }
+  uint8_t Count() const { return _count; }
+
+  // the switcher sends text, the parser reads what arrived, as one loop()
+  void Send(const std::string& text) {
+    CHECK_EQ(write(_switcher, text.data(), text.size()), text.size());
+    // the pty hands the bytes over asynchronously
+    for (int wait = 0; wait < 1000 && _port.available() < (int)text.size();
+         wait++) {
+      usleep(1000);
+    }
+    CHECK_EQ(_port.available(), text.size());
+    for (int pending = _port.available(); pending > 0; pending--) {
+      if (_qpl.Push(_port.read())) {
+        frames++;
+        _count = _qpl.Count();
+        for (uint8_t i = 0; i < MAXPARAM; i++) {
+          _params[i] = _qpl.Param((ROLAND_PARAM)i);
+        }
+      }
+    }
+  }
+};
+
+void TestWhole() {
+  Wire wire;
+  wire.Send(std::string(kStx) + "QPL:3,1,0,1,0,2,128,255;");
+  CHECK_EQ(wire.frames, 1);
+  CHECK_EQ(wire.Count(), MAXPARAM);
+  CHECK_EQ(wire.Param(PGM), 3);
+  CHECK_EQ(wire.Param(PST), 1);
+  CHECK_EQ(wire.Param(SPLIT), 1);
+  CHECK_EQ(wire.Param(TRANSITION), 2);
+  CHECK_EQ(wire.Param(FADE), 128);
+  CHECK_EQ(wire.Param(FADER), 255);
+
+  // ACK in place of ';', and only PGM/PST
+  wire.Send(std::string(kStx) + "QPL:2,0" + kAck);
+  CHECK_EQ(wire.frames, 2);
+  CHECK_EQ(wire.Count(), 2);
+  CHECK_EQ(wire.Param(PGM), 2);
+  CHECK_EQ(wire.Param(PST), 0);
+  CHECK_EQ(wire.Param(DSK), 0);
+}
+
+void TestFragmented() {
+  Wire wire;
+  std::string frame = std::string(kStx) + "QPL:1,2,0,0,0,0,100,200;";
+  // one byte per loop()
+  for (size_t i = 0; i < frame.size(); i++) {
+    wire.Send(frame.substr(i, 1));
+    CHECK_EQ(wire.frames, i + 1 == frame.size() ? 1 : 0);
+  }
+  CHECK_EQ(wire.Param(PGM), 1);
+  CHECK_EQ(wire.Param(PST), 2);
+  CHECK_EQ(wire.Param(FADER), 200);
+
+  // split inside the header, inside a number, and with the next frame
+  // starting in the same read as the end of the previous one
+  wire.Send(std::string(kStx) + "QP");
+  wire.Send("L:3,1");
+  wire.Send("2,0,0,0,0,0,0;" + std::string(kStx) + "QPL:0,");
+  CHECK_EQ(wire.frames, 2);
+  CHECK_EQ(wire.Param(PGM), 3);
+  CHECK_EQ(wire.Param(PST), 12);
+  wire.Send("3;");
+  CHECK_EQ(wire.frames, 3);
+  CHECK_EQ(wire.Param(PGM), 0);
+  CHECK_EQ(wire.Param(PST), 3);
+}
+
+void TestNoise() {
+  Wire wire;
+  // garbage, then a frame cut off by a new STX
+  wire.Send(std::string("\xFF\0zz;", 5) + kStx + "QP" + kStx + "QPL:2,3;");
+  CHECK_EQ(wire.frames, 1);
+  CHECK_EQ(wire.Param(PGM), 2);
+  CHECK_EQ(wire.Param(PST), 3);
+
+  // a stray byte inside the fields or the header drops the frame
+  wire.Send(std::string(kStx) + "QPL:1,X2;");
+  wire.Send(std::string(kStx) + "QRL:1,2;");
+  CHECK_EQ(wire.frames, 1);
+  // ';' before PST: not a complete frame
+  wire.Send(std::string(kStx) + "QPL:1;");
+  CHECK_EQ(wire.frames, 1);
+  CHECK_EQ(wire.Param(PGM), 2);
+
+  // values above 255 are clamped, parameters past FADER ignored
+  wire.Send(std::string(kStx) + "QPL:1,0,0,0,0,0,99999,300,7,8;");
+  CHECK_EQ(wire.frames, 2);
+  CHECK_EQ(wire.Count(), MAXPARAM);
+  CHECK_EQ(wire.Param(FADE), 255);
+  CHECK_EQ(wire.Param(FADER), 255);
+}
+
+}  // namespace
+
+int main() {
+  TestWhole();
+  TestFragmented();
+  TestNoise();
+  return test::Result("test_roland_qpl");
+}
@@ -0,0 +1,226 @@
+/**
+ * RolandSource poll rate against a simulated switcher, on hal::ManualClock:
+ * over RS-232 (the SoftwareSerial pty) a late answer must not switch it to
+ * push mode; over LAN (a local TCP server) neither must a switcher that
+ * always answers late, a few unsolicited status frames do, a long run of
+ * answers to requests and a reconnect go back to fast polling.
+ *
+ * usage: test_roland_source
+ */
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <deque>
+#include <string>
+
+#include "hal.h"
+#include "roland_source.h"
+#include "test.h"
+#include "test_net.h"
+
+namespace {
+
+const uint16_t kPort = 50997;
+const char kRequest[] = "\x02QPL:8;";
+const char kStatus[] = "\x02QPL:1,2,0,0,0,0,0,255;";
+// fast polling answers well over this many requests a second, push mode
+// (one per ROLAND_POLL_MAX_MS) well under
+const int kFastRate = 20;
+
+hal::ManualClock& clock = test::Clock();
+
+/**
+ * @brief the switcher end of the serial port or TCP connection
+ */
+class Switcher {
+ private:
+  int _fd;
+  bool _pty;
+  int _request_bytes = 0;
+
+  // the pty hands bytes over asynchronously, TCP on loopback at once
+  void Settle() {
+    if (_pty) usleep(300);
+  }
+
+ public:
+  Switcher(int fd, bool pty) : _fd(fd), _pty(pty) {
+    fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) | O_NONBLOCK);
+  }
+  ~Switcher() { close(_fd); }
+
+  // complete requests read since the last call
+  int Requests() {
+    Settle();
+    char buffer[64];
+    ssize_t n;
+    while ((n = read(_fd, buffer, sizeof(buffer))) > 0) {
+      _request_bytes += n;
+    }
+    int requests = _request_bytes / (sizeof(kRequest) - 1);
+    _request_bytes %= sizeof(kRequest) - 1;
+    return requests;
+  }
+
+  // frames in one write, so that they arrive together
+  void Status(int frames = 1) {
+    std::string status;
+    for (int i = 0; i < frames; i++) status += kStatus;
+    CHECK_EQ(write(_fd, status.data(), status.size()), status.size());
+    Settle();
+  }
+};
+
+/**
+ * @brief runs the source for ms milliseconds with the switcher answering
+ *  every request at once
+ * @return requests answered per second
+ */
+int AnswerFor(RolandSource* source, Switcher* switcher, unsigned long ms) {
+  int answered = 0;
+  unsigned long start = millis();
+  while (millis() - start < ms) {
+    source->Poll();
+    for (int requests = switcher->Requests(); requests > 0; requests--) {
+      switcher->Status();
+      answered++;
+    }
+    clock.Advance(1000);
+  }
+  return answered * 1000 / ms;
+}
+
+/**
+ * @brief runs the source for ms milliseconds with the switcher answering
+ *  every request delay_ms late, after the source gave up on it, then at
+ *  once until none is left unanswered
+ */
+void AnswerLateFor(RolandSource* source, Switcher* switcher, unsigned long ms,
+                   unsigned long delay_ms) {
+  std::deque<unsigned long> due;
+  unsigned long start = millis();
+  while (millis() - start < ms || !due.empty()) {
+    source->Poll();
+    for (int requests = switcher->Requests(); requests > 0; requests--) {
+      due.push_back(millis() + (millis() - start < ms ? delay_ms : 0));
+    }
+    while (!due.empty() && (long)(millis() - due.front()) >= 0) {
+      switcher->Status();
+      due.pop_front();
+    }
+    clock.Advance(1000);
+  }
+}
+
+// polls until the source sends a request, which is left unanswered
+void WaitForRequest(RolandSource* source, Switcher* switcher) {
+  for (int ms = 0; ms <= ROLAND_POLL_MAX_MS && !switcher->Requests(); ms++) {
+    source->Poll();
+    clock.Advance(1000);
+  }
+}
+
+// answers the next request twice, the second one is unsolicited
+void Unsolicited(RolandSource* source, Switcher* switcher) {
+  WaitForRequest(source, switcher);
+  switcher->Status(2);
+}
+
+// polls without answering, the requests are left unread
+void SilenceFor(RolandSource* source, unsigned long ms) {
+  unsigned long start = millis();
+  while (millis() - start < ms) {
+    source->Poll();
+    clock.Advance(1000);
+  }
+}
+
+void TestSerialLateAnswer() {
+  char dir[] = "/tmp/test_roland_XXXXXX";
+  CHECK(mkdtemp(dir) != nullptr);
+  setenv("HAL_PTY_DIR", dir, 1);
+  RolandSource source(IPAddress(127, 0, 0, 1));
+  source.Begin();
+  std::string link = std::string(dir) + "/serial-" +
+                     std::to_string(rolandRX) + "-" + std::to_string(rolandTX);
+  int fd = open(link.c_str(), O_RDWR | O_NOCTTY);
+  CHECK(fd >= 0);
+  Switcher switcher(fd, true);
+
+  CHECK(AnswerFor(&source, &switcher, 1000) > kFastRate);
+  CHECK_EQ(source.Health(), SOURCE_UP);
+
+  // the switcher stops answering and the interval grows to
+  // ROLAND_POLL_MAX_MS; then a request times out and is answered after all,
+  // when no request is pending. Over RS-232 that is never a push.
+  for (int i = 0; i < 2 * ROLAND_PUSH_FRAMES; i++) {
+    SilenceFor(&source, 2000);
+    switcher.Requests();
+    WaitForRequest(&source, &switcher);
+    SilenceFor(&source, ROLAND_TIMEOUT_MS + 10);
+    CHECK_EQ(switcher.Requests(), 0);
+    switcher.Status();
+    AnswerFor(&source, &switcher, 1000);
+    CHECK(AnswerFor(&source, &switcher, 1000) > kFastRate);
+  }
+
+  source.Teardown();
+  unlink(link.c_str());
+  rmdir(dir);
+  unsetenv("HAL_PTY_DIR");
+}
+
+void TestLanPush() {
+  int server = test::ListenLoopback(kPort);
+  RolandSource source(IPAddress(127, 0, 0, 1), kPort);
+  source.UseLan(true);
+  source.Begin();
+  auto poll = [&source] { source.Poll(); };
+  {
+    Switcher switcher(test::AcceptWhilePolling(poll, server), false);
+    CHECK(AnswerFor(&source, &switcher, 1000) > kFastRate);
+
+    // a slow switcher: every answer comes after the next request went out,
+    // none of them is unsolicited
+    AnswerLateFor(&source, &switcher, 5000, ROLAND_TIMEOUT_MS + 50);
+    AnswerFor(&source, &switcher, 1000);
+    CHECK(AnswerFor(&source, &switcher, 1000) > kFastRate);
+
+    // fewer unsolicited frames than ROLAND_PUSH_FRAMES: still polling fast
+    for (int i = 0; i + 1 < ROLAND_PUSH_FRAMES; i++) {
+      Unsolicited(&source, &switcher);
+      CHECK(AnswerFor(&source, &switcher, 1000) > kFastRate);
+    }
+
+    // the switcher pushes changes: polling slows down to a resync
+    Unsolicited(&source, &switcher);
+    AnswerFor(&source, &switcher, 1000);
+    int rate = AnswerFor(&source, &switcher, 1000);
+    CHECK(rate > 0);
+    CHECK(rate <= 1000 / ROLAND_POLL_MAX_MS + 1);
+
+    // the switcher stopped pushing: after a long run of answers to
+    // requests, polling is fast again
+    AnswerFor(&source, &switcher,
+              ROLAND_PUSH_DECAY_FRAMES * ROLAND_POLL_MAX_MS + 1000);
+    CHECK(AnswerFor(&source, &switcher, 1000) > kFastRate);
+  }
+
+  // the connection drops: after the reconnect it polls fast again
+  {
+    Switcher switcher(test::AcceptWhilePolling(poll, server), false);
+    CHECK(AnswerFor(&source, &switcher, 1000) > kFastRate);
+    CHECK_EQ(source.Health(), SOURCE_UP);
+  }
+  source.Teardown();
+  close(server);
+}
+
+}  // namespace
+
+int main() {
+  TestSerialLateAnswer();
+  TestLanPush();
+  return test::Result("test_roland_source");
+}
@@ -0,0 +1,95 @@
+/**
+ * SourceClient reconnect backoff against a local TCP server: a dropped
+ * connection waits out the backoff, the backoff keeps growing while the
+ * server drops connections without answering, and only starts over once the
+ * source reports a complete line with Answered().
+ *
+ * usage: test_source_client
+ */
+#include <unistd.h>
+
+#include "hal.h"
+#include "tally_source.h"
+#include "test.h"
+#include "test_net.h"
+
+namespace {
+
+const uint16_t kPort = 50996;
+
+hal::ManualClock& clock = test::Clock();
+
+// the server takes the connection and hangs up
+void Drop(int server) {
+  // the client is connected already, nothing to poll
+  int fd = test::AcceptWhilePolling([] {}, server);
+  if (fd >= 0) close(fd);
+}
+
+// advances until the client is connected again, returns the ms it took
+unsigned long Reconnect(SourceClient* client) {
+  unsigned long start = millis();
+  for (int ms = 0; ms <= CLIENT_BACKOFF_MAX_MS; ms++) {
+    if (client->Advance()) return millis() - start;
+    // FAILED -> CONNECTING takes a step of its own
+    if (client->State() == CLIENT_FAILED) clock.Advance(1000);
+  }
+  return 0;
+}
+
+// the drop is seen, then the client waits `expected` ms to reconnect
+void CheckBackoff(SourceClient* client, int server, unsigned long expected) {
+  Drop(server);
+  CHECK(!client->Advance());
+  CHECK_EQ(client->State(), CLIENT_FAILED);
+  CHECK_EQ(client->Health(), SOURCE_CONNECTING);
+  CHECK_EQ(Reconnect(client), expected);
+  CHECK_EQ(client->State(), CLIENT_SUBSCRIBED);
+}
+
+}  // namespace
+
+int main() {
+  int server = test::ListenLoopback(kPort);
+  SourceClient client("TEST", IPAddress(127, 0, 0, 1), kPort);
+
+  client.Begin();
+  CHECK(client.Advance());
+  CHECK_EQ(client.State(), CLIENT_SUBSCRIBED);
+  // connected but never answered: each drop doubles the wait
+  CheckBackoff(&client, server, CLIENT_BACKOFF_MIN_MS);
+  CheckBackoff(&client, server, 2 * CLIENT_BACKOFF_MIN_MS);
+  CheckBackoff(&client, server, 4 * CLIENT_BACKOFF_MIN_MS);
+
+  // an answer on the connection starts the backoff over
+  client.Answered();
+  CheckBackoff(&client, server, CLIENT_BACKOFF_MIN_MS);
+  CheckBackoff(&client, server, 2 * CLIENT_BACKOFF_MIN_MS);
+
+  // refused connections keep doubling up to the maximum
+  Drop(server);
+  close(server);
+  CHECK(!client.Advance());
+  unsigned long backoff = 4 * CLIENT_BACKOFF_MIN_MS;
+  for (int attempt = 0; attempt < 8; attempt++) {
+    unsigned long start = millis();
+    while (!client.Advance() && client.State() == CLIENT_FAILED) {
+      clock.Advance(1000);
+    }
+    CHECK_EQ(millis() - start, backoff);
+    CHECK(!client.Advance());
+    CHECK_EQ(client.State(), CLIENT_FAILED);
+    backoff = backoff * 2 < CLIENT_BACKOFF_MAX_MS ? backoff * 2
+                                                   : CLIENT_BACKOFF_MAX_MS;
+  }
+
+  // Begin() starts over
+  server = test::ListenLoopback(kPort);
+  client.Begin();
+  CHECK(client.Advance());
+  CheckBackoff(&client, server, CLIENT_BACKOFF_MIN_MS);
+  client.Stop();
+  CHECK_EQ(client.Health(), SOURCE_DOWN);
+  close(server);
+  return test::Result("test_source_client");
+}
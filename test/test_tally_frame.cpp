@@ -0,0 +1,230 @@
+/**
+ * TallyFrame encode -> decode round trips for keyframes, deltas and acks,
+ * and the decoder's rejection of bad CRCs, a missing SYNC and frames cut
+ * short or with an impossible length.
+ *
+ * usage: test_tally_frame
+ */
+#include <string.h>
+
+#include <vector>
+
+#include "TallyFrame.h"
+#include "test.h"
+
+namespace {
+
+typedef std::vector<uint8_t> Bytes;
+
+// pushes every byte, returns how many frames the decoder completed
+int Feed(TallyFrameDecoder* decoder, const Bytes& bytes) {
+  int frames = 0;
+  for (uint8_t c : bytes) {
+    if (decoder->Push(c)) frames++;
+  }
+  return frames;
+}
+
+Bytes Key(uint8_t group, uint8_t sequence, const uint8_t* states,
+          uint8_t cameras) {
+  uint8_t frame[TALLY_FRAME_MAX_LENGTH];
+  uint8_t length = TallyFrameEncodeKey(frame, group, sequence, states, cameras);
+  return Bytes(frame, frame + length);
+}
+
+void FillStates(uint8_t* states, uint8_t cameras, uint8_t seed) {
+  memset(states, 0, TALLY_FRAME_STATE_BYTES(TALLY_FRAME_MAX_CAMERAS));
+  for (uint16_t camera = 0; camera < cameras; camera++) {
+    TallyFrameSetState(states, camera, (camera * 7 + seed) % 3);
+  }
+}
+
+void TestCrc() {
+  // CRC-8, polynomial 0x07, init 0: check value of "123456789"
+  const char* check = "123456789";
+  CHECK_EQ(TallyFrameCrc8((const uint8_t*)check, 9), 0xF4);
+  CHECK_EQ(TallyFrameCrc8(nullptr, 0), 0);
+}
+
+void TestKeyRoundTrip() {
+  const uint8_t kCameras[] = {1, 4, 5, 8, 13, 64, 255};
+  uint8_t states[TALLY_FRAME_STATE_BYTES(TALLY_FRAME_MAX_CAMERAS)];
+  uint8_t decoded[TALLY_FRAME_STATE_BYTES(TALLY_FRAME_MAX_CAMERAS)];
+  for (uint8_t cameras : kCameras) {
+    FillStates(states, cameras, cameras);
+    Bytes frame = Key(cameras % 8, cameras, states, cameras);
+    CHECK_EQ(frame.size(), TALLY_FRAME_HEADER_LENGTH +
+                               TALLY_FRAME_STATE_BYTES(cameras) + 1);
+
+    TallyFrameDecoder decoder;
+    for (size_t i = 0; i + 1 < frame.size(); i++) {
+      CHECK(!decoder.Push(frame[i]));
+    }
+    CHECK(decoder.Push(frame.back()));
+    CHECK_EQ(decoder.Type(), TALLY_FRAME_KEY);
+    CHECK_EQ(decoder.Group(), cameras % 8);
+    CHECK_EQ(decoder.Sequence(), cameras);
+    CHECK_EQ(decoder.Count(), cameras);
+    CHECK_EQ(decoder.Length(), frame.size());
+
+    // cameras the keyframe does not cover go off
+    memset(decoded, 0xFF, sizeof(decoded));
+    decoder.Apply(decoded, 255);
+    for (uint16_t camera = 0; camera < 255; camera++) {
+      CHECK_EQ(TallyFrameGetState(decoded, camera),
+               camera < cameras ? TallyFrameGetState(states, camera)
+                                : TALLY_FRAME_OFF);
+    }
+    CHECK_EQ(decoder.Errors(), 0);
+  }
+}
+
+void TestDeltaRoundTrip() {
+  const uint8_t kCameras = 16;
+  uint8_t previous[TALLY_FRAME_STATE_BYTES(kCameras)] = {0};
+  uint8_t states[TALLY_FRAME_STATE_BYTES(kCameras)] = {0};
+  TallyFrameSetState(previous, 2, TALLY_FRAME_PROGRAM);
+  TallyFrameSetState(previous, 5, TALLY_FRAME_PREVIEW);
+  memcpy(states, previous, sizeof(states));
+  // a cut: 5 to program, 2 to preview
+  TallyFrameSetState(states, 2, TALLY_FRAME_PREVIEW);
+  TallyFrameSetState(states, 5, TALLY_FRAME_PROGRAM);
+
+  uint8_t frame[TALLY_FRAME_MAX_LENGTH];
+  uint8_t length =
+      TallyFrameEncodeDelta(frame, 3, 42, states, previous, kCameras);
+  CHECK_EQ(length, TALLY_FRAME_HEADER_LENGTH + 2 + 1);
+
+  TallyFrameDecoder decoder;
+  CHECK_EQ(Feed(&decoder, Bytes(frame, frame + length)), 1);
+  CHECK_EQ(decoder.Type(), TALLY_FRAME_DELTA);
+  CHECK_EQ(decoder.Group(), 3);
+  CHECK_EQ(decoder.Sequence(), 42);
+  CHECK_EQ(decoder.Count(), 2);
+  uint8_t applied[TALLY_FRAME_STATE_BYTES(kCameras)];
+  memcpy(applied, previous, sizeof(applied));
+  decoder.Apply(applied, kCameras);
+  CHECK(!memcmp(applied, states, sizeof(states)));
+
+  // nothing changed: an empty delta
+  length = TallyFrameEncodeDelta(frame, 0, 1, states, states, kCameras);
+  CHECK_EQ(length, TALLY_FRAME_HEADER_LENGTH + 1);
+  CHECK_EQ(Feed(&decoder, Bytes(frame, frame + length)), 1);
+  CHECK_EQ(decoder.Count(), 0);
+
+  // as long as the keyframe, or a camera above TALLY_FRAME_DELTA_CAMERAS
+  memset(states, 0xAA, sizeof(states));
+  CHECK_EQ(TallyFrameEncodeDelta(frame, 0, 1, states, previous, kCameras), 0);
+  uint8_t wide[TALLY_FRAME_STATE_BYTES(80)] = {0};
+  uint8_t wide_previous[TALLY_FRAME_STATE_BYTES(80)] = {0};
+  TallyFrameSetState(wide, TALLY_FRAME_DELTA_CAMERAS, TALLY_FRAME_PROGRAM);
+  CHECK_EQ(TallyFrameEncodeDelta(frame, 0, 1, wide, wide_previous, 80), 0);
+}
+
+void TestAckRoundTrip() {
+  TallyFrameAck ack = {5, 2, 200, TALLY_FRAME_ACK_IN_SYNC, 3, 4, 77};
+  uint8_t frame[TALLY_FRAME_MAX_LENGTH];
+  uint8_t length = TallyFrameEncodeAck(frame, ack);
+  CHECK_EQ(length, TALLY_FRAME_ACK_LENGTH);
+
+  TallyFrameDecoder decoder;
+  CHECK_EQ(Feed(&decoder, Bytes(frame, frame + length)), 1);
+  TallyFrameAck decoded;
+  CHECK(decoder.Ack(&decoded));
+  CHECK_EQ(decoded.receiver, 5);
+  CHECK_EQ(decoded.group, 2);
+  CHECK_EQ(decoded.sequence, 200);
+  CHECK_EQ(decoded.flags, TALLY_FRAME_ACK_IN_SYNC);
+  CHECK_EQ(decoded.lost, 3);
+  CHECK_EQ(decoded.errors, 4);
+  CHECK_EQ(decoded.rssi, 77);
+
+  // an ack leaves the states alone
+  uint8_t states[2] = {0x12, 0x34};
+  decoder.Apply(states, 8);
+  CHECK_EQ(states[0], 0x12);
+  CHECK_EQ(states[1], 0x34);
+}
+
+void TestRejects() {
+  uint8_t states[TALLY_FRAME_STATE_BYTES(8)];
+  FillStates(states, 8, 1);
+  Bytes good = Key(1, 9, states, 8);
+
+  // every bit flip of the CRC or payload is caught
+  for (size_t i = 1; i < good.size(); i++) {
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      Bytes bad = good;
+      bad[i] ^= 1 << bit;
+      TallyFrameDecoder decoder;
+      CHECK_EQ(Feed(&decoder, bad), 0);
+    }
+  }
+  {
+    Bytes bad = good;
+    bad.back() ^= 0x01;
+    TallyFrameDecoder decoder;
+    CHECK_EQ(Feed(&decoder, bad), 0);
+    CHECK_EQ(decoder.Errors(), 1);
+    // the decoder is not stuck: the next frame comes through
+    CHECK_EQ(Feed(&decoder, good), 1);
+  }
+
+  // without its SYNC byte a frame is not seen at all
+  {
+    Bytes bad(good.begin() + 1, good.end());
+    TallyFrameDecoder decoder;
+    CHECK_EQ(Feed(&decoder, bad), 0);
+    bad = good;
+    bad[0] = 0x5A;
+    CHECK_EQ(Feed(&decoder, bad), 0);
+    CHECK_EQ(Feed(&decoder, good), 1);
+  }
+
+  // a frame cut short is dropped, the one behind it is recovered
+  {
+    Bytes stream(good.begin(), good.end() - 2);
+    stream.insert(stream.end(), good.begin(), good.end());
+    TallyFrameDecoder decoder;
+    CHECK_EQ(Feed(&decoder, stream), 1);
+    CHECK_EQ(decoder.Sequence(), 9);
+    CHECK(decoder.Errors() > 0);
+  }
+
+  // noise and stray SYNC bytes before a frame
+  {
+    Bytes stream = {0x00, TALLY_FRAME_SYNC, 0xFF, TALLY_FRAME_SYNC,
+                    TALLY_FRAME_SYNC, 0x13};
+    stream.insert(stream.end(), good.begin(), good.end());
+    TallyFrameDecoder decoder;
+    CHECK_EQ(Feed(&decoder, stream), 1);
+    CHECK_EQ(decoder.Sequence(), 9);
+  }
+
+  // impossible lengths: a delta listing more than TALLY_FRAME_DELTA_CAMERAS
+  // cameras, an unknown version or type
+  {
+    const uint8_t kHeaders[] = {
+        (TALLY_FRAME_VERSION << 5) | (TALLY_FRAME_DELTA << 3),
+        ((TALLY_FRAME_VERSION + 1) << 5) | (TALLY_FRAME_KEY << 3),
+        (TALLY_FRAME_VERSION << 5) | (3 << 3)};
+    for (uint8_t header : kHeaders) {
+      Bytes bad = {TALLY_FRAME_SYNC, header, 0, TALLY_FRAME_DELTA_CAMERAS + 1};
+      TallyFrameDecoder decoder;
+      CHECK_EQ(Feed(&decoder, bad), 0);
+      CHECK_EQ(decoder.Errors(), 1);
+      CHECK_EQ(Feed(&decoder, good), 1);
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestCrc();
+  TestKeyRoundTrip();
+  TestDeltaRoundTrip();
+  TestAckRoundTrip();
+  TestRejects();
+  return test::Result("test_tally_frame");
+}
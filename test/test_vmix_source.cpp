@@ -0,0 +1,170 @@
+/**
+ * VmixSource with ACTS against a local TCP server: an input that is only in
+ * an overlay arrives as program in a TALLY resync, and must go off when the
+ * overlay does, also after a cut to another input. A vMix that refuses ACTS
+ * gets SUBSCRIBE TALLY instead, and so after a reconnect.
+ *
+ * usage: test_vmix_source
+ */
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "hal.h"
+#include "test.h"
+#include "test_net.h"
+#include "vmix_source.h"
+
+namespace {
+
+const uint16_t kPort = 50998;
+
+class Vmix {
+ private:
+  VmixSource* _source;
+  int _server;
+  int _fd = -1;
+
+ public:
+  explicit Vmix(VmixSource* source)
+      : _source(source), _server(test::ListenLoopback(kPort)) {}
+  ~Vmix() {
+    if (_fd >= 0) close(_fd);
+    close(_server);
+  }
+
+  // polls the source until it has connected
+  void Accept() {
+    _fd = test::AcceptWhilePolling([this] { _source->Poll(); }, _server);
+  }
+
+  // what the source sent since the last call
+  std::string Received() {
+    std::string text;
+    char buffer[64];
+    ssize_t n;
+    while ((n = read(_fd, buffer, sizeof(buffer))) > 0) {
+      text.append(buffer, n);
+    }
+    return text;
+  }
+
+  // vMix closes the connection
+  void Drop() {
+    close(_fd);
+    _fd = -1;
+  }
+
+  // a line from vMix, parsed by the next Poll()
+  void Send(const char* line) {
+    std::string text = std::string(line) + "\r\n";
+    CHECK_EQ(write(_fd, text.data(), text.size()), text.size());
+    _source->Poll();
+  }
+};
+
+// "P" program, "V" preview, "-" off for cameras 1, 2, ...
+std::string Cameras(const VmixSource& source, uint8_t cameras) {
+  std::string state;
+  for (uint8_t camera = 0; camera < cameras; camera++) {
+    tally_mask_t bit = (tally_mask_t)1 << (camera % TALLY_MASK_BITS);
+    uint8_t w = camera / TALLY_MASK_BITS;
+    state += (source.Program(0)[w] & bit)   ? 'P'
+             : (source.Preview(0)[w] & bit) ? 'V'
+                                            : '-';
+  }
+  return state;
+}
+
+#define CHECK_CAMERAS(source, expected) \
+  CHECK(Cameras(source, strlen(expected)) == expected)
+
+void TestOverlay() {
+  VmixSource source(IPAddress(127, 0, 0, 1), kPort);
+  source.UseActs(true);
+  Vmix vmix(&source);
+  source.Begin();
+  vmix.Accept();
+  CHECK(vmix.Received() == "SUBSCRIBE ACTS\r\nTALLY\r\n");
+
+  // input 1 on program, 3 only in overlay 1, 4 on preview
+  vmix.Send("TALLY OK 1012");
+  CHECK_CAMERAS(source, "P-PV");
+  CHECK_EQ(source.Health(), SOURCE_UP);
+
+  // overlay 1 goes off: input 3 may still be on program, ask again
+  vmix.Send("ACTS OK Overlay1 3 0");
+  std::string request = vmix.Received();
+  CHECK(request == "TALLY\r\n");
+  if (!request.empty()) vmix.Send("TALLY OK 1002");
+  CHECK_CAMERAS(source, "P--V");
+
+  // cut to input 4: input 3 stays off
+  vmix.Send("ACTS OK Input 1 0");
+  vmix.Send("ACTS OK Input 4 1");
+  vmix.Send("ACTS OK InputPreview 4 0");
+  vmix.Send("ACTS OK InputPreview 1 1");
+  CHECK_CAMERAS(source, "V--P");
+
+  // an overlay known from ACTS goes off without another TALLY
+  vmix.Send("ACTS OK Overlay2 2 1");
+  CHECK_CAMERAS(source, "VP-P");
+  vmix.Send("ACTS OK Overlay2 2 0");
+  CHECK_CAMERAS(source, "V--P");
+  // and so does one that moves to another input
+  vmix.Send("ACTS OK Overlay2 2 1");
+  vmix.Send("ACTS OK Overlay2 3 1");
+  CHECK_CAMERAS(source, "V-PP");
+  CHECK(vmix.Received().empty());
+
+  // an overlay survives a resync, which shows its input as program
+  vmix.Send("TALLY OK 2011");
+  CHECK_CAMERAS(source, "V-PP");
+  vmix.Send("ACTS OK Overlay2 3 0");
+  request = vmix.Received();
+  CHECK(request == "TALLY\r\n");
+  if (!request.empty()) vmix.Send("TALLY OK 2001");
+  CHECK_CAMERAS(source, "V--P");
+
+  source.Teardown();
+  CHECK_CAMERAS(source, "----");
+}
+
+void TestActsRefused() {
+  VmixSource source(IPAddress(127, 0, 0, 1), kPort);
+  source.UseActs(true);
+  Vmix vmix(&source);
+  source.Begin();
+  vmix.Accept();
+  CHECK(vmix.Received() == "SUBSCRIBE ACTS\r\nTALLY\r\n");
+  vmix.Send("SUBSCRIBE ER Unknown");
+  CHECK(vmix.Received() == "SUBSCRIBE TALLY\r\n");
+  vmix.Send("TALLY OK 12");
+  CHECK_CAMERAS(source, "PV");
+
+  // the same server is not asked for ACTS again
+  vmix.Drop();
+  vmix.Accept();
+  CHECK(vmix.Received() == "SUBSCRIBE TALLY\r\n");
+  vmix.Send("TALLY OK 21");
+  CHECK_CAMERAS(source, "VP");
+
+  // Begin() tries again
+  source.Teardown();
+  vmix.Drop();
+  source.Begin();
+  vmix.Accept();
+  CHECK(vmix.Received() == "SUBSCRIBE ACTS\r\nTALLY\r\n");
+  source.Teardown();
+}
+
+}  // namespace
+
+int main() {
+  // the manual clock, before the source reads it
+  test::Clock();
+  TestOverlay();
+  TestActsRefused();
+  return test::Result("test_vmix_source");
+}
@@ -1,15 +1,38 @@
 #include <ArduinoLog.h>
 #include <SoftwareSerial.h>
+#include <TallyFrame.h>
 
 // Uncomment line below to fully disable logging
 // #define DISABLE_LOGGING
 
+#include "atem_source.h"
+#include "rf_link.h"
+#include "roland_source.h"
 #include "tally.h"
+#include "vmix_source.h"
 
 SoftwareSerial RF(8, 9);  // RX, TX
 
-uint8_t send_data[MAX_TALLY + 2] = {0x30};
-uint8_t *camera_status = nullptr;
+// one source per position of the device switch, for the protocols enabled
+// in tally_config.h
+#if TALLY_ATEM
+AtemSource atem(IPAddress(192, 168, 0, 100));
+#endif
+#if TALLY_VMIX
+VmixSource vmix(IPAddress(192, 168, 0, 100));
+#endif
+#if TALLY_ROLAND
+RolandSource roland(IPAddress(192, 168, 0, 100));
+#endif
+
+RfLink rf_link(&RF);
+uint8_t changed_groups = 0;
+#if RF_ACKS
+unsigned long receivers_logged_at = 0;
+#if TALLY_ROLAND
+bool roland_serial_logged = false;
+#endif
+#endif
 
 void setup() {
   Serial.begin(115200);
@@ -21,29 +44,65 @@ void setup() {
   RF.begin(9600);
   Log.notice("Start" CR);
 
-  // init start/stop value
-  send_data[0] = 0x31;
-  send_data[MAX_TALLY + 1] = 0x3B;
-
   // start tally
   Tally::Instance()->Begin();
+#if TALLY_ATEM
+  Tally::Instance()->AddSource(&atem, ATEM);
+  // ATEM: also light camera 2 while SuperSource (6000) is on program/preview
+  // atem.AddSourceFeed(6000, 2);
+  // ATEM: M/E 2 as RF group 1 (build with -DTALLY_GROUPS=2), or merged
+  // into the main tally with RouteMe(2, 0)
+  // atem.RouteMe(2, 1);
+#endif
+#if TALLY_VMIX
+  Tally::Instance()->AddSource(&vmix, VMIX);
+  // vMix: per-input activator events instead of the full tally string
+  // vmix.UseActs(true);
+#endif
+#if TALLY_ROLAND
+  Tally::Instance()->AddSource(&roland, ROLAND);
+  // ROLAND: V-60HD/V-160HD over LAN (TCP 8023) instead of RS-232
+  // roland.UseLan(true);
+#endif
+  // all sources at once instead of the one on the device switch, e.g. ATEM
+  // for the cameras and vMix for graphics/ISO, lit if either lights them;
+  // camera 8 follows vMix only
+  // Tally::Instance()->RunAllSources(MERGE_OR);
+  // Tally::Instance()->AssignCamera(8, &vmix);
   Tally::Instance()->InitConnectionWithServerSide();
+  // RF: keyframe every 500 ms, each change sent 3 more times 30 ms apart
+  // rf_link.SetKeyframeInterval(500);
+  // rf_link.SetRepeats(3, 30);
+  // RF: send preview changes at once instead of merging them for 50 ms
+  // rf_link.SetHoldTime(0);
 }
 
 void loop() {
-  camera_status = Tally::Instance()->ProcessTally();
-  if (camera_status) {
-    uint8_t len = (Tally::Instance()->WhichDevice() != ROLAND &&
-                   strlen(camera_status) <= MAX_TALLY)
-                      ? strlen(camera_status)
-                      : 4;
-    memcpy(send_data + 1, camera_status, len);
-
-    for (uint8_t i = 0; i < ARRAY_SIZE(send_data); i++) {
-      Log.notice("%d" CR, send_data[i]);
+  changed_groups = Tally::Instance()->ProcessTally();
+  for (uint8_t group = 0; changed_groups; group++, changed_groups >>= 1) {
+    if (!(changed_groups & 1)) {
+      continue;
     }
-    RF.println((const char)send_data);
+    rf_link.Update(group, Tally::Instance()->CameraStatus(group),
+                   Tally::Instance()->CameraCount());
+  }
+  // changes go out right away, repeats and keyframes when due
+  rf_link.Poll();
+#if RF_ACKS
+  if (millis() - receivers_logged_at > 10000) {
+    receivers_logged_at = millis();
+    rf_link.DumpReceivers();
+  }
+#if TALLY_ROLAND
+  // acks need RF to be the listening SoftwareSerial, and Roland over RS-232
+  // takes that over: no ack arrives and every receiver looks behind
+  if (!roland_serial_logged && !roland.Lan() &&
+      roland.Health() != SOURCE_DOWN) {
+    roland_serial_logged = true;
+    Log.warning("RF acks are lost with Roland over RS-232, use LAN" CR);
   }
+#endif
+#endif
   Tally::Instance()->CheckConnection();
   Tally::Instance()->HandleSwitchDevice();
 }
@@ -0,0 +1,139 @@
+#ifndef VMIX_PROTOCOL_h
+#define VMIX_PROTOCOL_h
+
+#include <Arduino.h>
+
+/**
+ * @brief splits the vMix TCP API stream into lines without touching the heap
+ *
+ * Bytes are pushed one at a time as they come off the socket, so a line may
+ * arrive over any number of loop() calls. Lines end with "\r\n" (a bare '\n'
+ * is accepted too); the CR/LF is stripped and the line is NUL-terminated in
+ * place. A line longer than SIZE keeps its first SIZE characters and the
+ * rest is dropped up to the line end: a TALLY line only needs the first
+ * MAX_TALLY digits.
+ */
+template <uint8_t SIZE>
+class LineReader {
+ private:
+  char _line[SIZE + 1];
+  uint8_t _length = 0;
+  bool _complete = false;
+
+ public:
+  /**
+   * @return true once c completes a line, see Line() and Length(); the line
+   *  stays valid until the next call
+   */
+  bool Push(char c) {
+    if (_complete) {
+      _length = 0;
+      _complete = false;
+    }
+    if (c == '\n') {
+      if (_length && _line[_length - 1] == '\r') {
+        _length--;
+      }
+      _line[_length] = '\0';
+      _complete = true;
+      return true;
+    }
+    if (_length < SIZE) {
+      _line[_length++] = c;
+    }
+    return false;
+  }
+
+  // drop a partial line, e.g. after reconnecting
+  void Clear() {
+    _length = 0;
+    _complete = false;
+  }
+
+  const char* Line() const { return _line; }
+  uint8_t Length() const { return _length; }
+};
+
+/**
+ * @brief finds the tally digits of a "TALLY OK 0121..." line in place
+ *  one digit per input: 0 = off, 1 = program, 2 = preview
+ *
+ * @param count set to the number of inputs in the line
+ * @return first digit (input 1), nullptr if this is not a TALLY line
+ */
+inline const char* VmixTallyStates(const char* line, uint8_t length,
+                                   uint8_t* count) {
+  static const char kTallyRsp[] PROGMEM = "TALLY OK ";
+  const uint8_t rsp_len = sizeof(kTallyRsp) - 1;
+  if (length < rsp_len || strncmp_P(line, kTallyRsp, rsp_len)) {
+    return nullptr;
+  }
+  *count = length - rsp_len;
+  return line + rsp_len;
+}
+
+typedef enum vmixActivator {
+  VMIX_ACT_OTHER,    // any activator the tally does not use
+  VMIX_ACT_INPUT,    // input on program
+  VMIX_ACT_PREVIEW,  // input on preview
+  VMIX_ACT_OVERLAY   // input in overlay channel 1-4
+} VMIX_ACTIVATOR;
+
+/**
+ * @brief one activator event, "ACTS OK Input 3 1"
+ */
+struct VmixActs {
+  VMIX_ACTIVATOR activator;
+  uint8_t overlay;  // overlay channel, for VMIX_ACT_OVERLAY
+  uint16_t input;   // 1-based vMix input
+  bool on;
+};
+
+/**
+ * @brief parses an "ACTS OK <activator> <input> <value>" line in place,
+ *  numbers are only read for the activators the tally uses
+ *
+ * @return false if this is not an ACTS line
+ */
+inline bool VmixActsEvent(const char* line, uint8_t length, VmixActs* event) {
+  static const char kActsRsp[] PROGMEM = "ACTS OK ";
+  static const char kInput[] PROGMEM = "Input";
+  static const char kPreview[] PROGMEM = "InputPreview";
+  static const char kOverlay[] PROGMEM = "Overlay";
+  const uint8_t rsp_len = sizeof(kActsRsp) - 1;
+  if (length < rsp_len || strncmp_P(line, kActsRsp, rsp_len)) {
+    return false;
+  }
+  const char* name = line + rsp_len;
+  const char* end = strchr(name, ' ');
+  event->activator = VMIX_ACT_OTHER;
+  if (!end) {
+    return true;
+  }
+  uint8_t name_len = end - name;
+  if (name_len == sizeof(kInput) - 1 && !strncmp_P(name, kInput, name_len)) {
+    event->activator = VMIX_ACT_INPUT;
+  } else if (name_len == sizeof(kPreview) - 1 &&
+             !strncmp_P(name, kPreview, name_len)) {
+    event->activator = VMIX_ACT_PREVIEW;
+  } else if (name_len == sizeof(kOverlay) &&
+             !strncmp_P(name, kOverlay, name_len - 1) &&
+             name[name_len - 1] >= '1' && name[name_len - 1] <= '4') {
+    event->activator = VMIX_ACT_OVERLAY;
+    event->overlay = name[name_len - 1] - '0';
+  } else {
+    return true;
+  }
+  const char* p = end + 1;
+  event->input = 0;
+  while (*p >= '0' && *p <= '9') {
+    event->input = event->input * 10 + (*p++ - '0');
+  }
+  event->on = *p == ' ' && p[1] == '1';
+  if (!event->input) {
+    event->activator = VMIX_ACT_OTHER;
+  }
+  return true;
+}
+
+#endif
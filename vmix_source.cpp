@@ -0,0 +1,172 @@
+#include "vmix_source.h"
+
+#if TALLY_VMIX
+
+void VmixSource::Begin() {
+  ClearCameras();
+  memset(_input, 0, sizeof(_input));
+  memset(_input_preview, 0, sizeof(_input_preview));
+  memset(_overlay, 0, sizeof(_overlay));
+  _acts_refused = false;
+  _lines.Clear();
+  _connection.Begin();
+}
+
+void VmixSource::Poll() {
+  if (_connection.Advance()) {
+    _lines.Clear();
+    memset(_overlay, 0, sizeof(_overlay));
+    if (_acts && !_acts_refused) {
+      // per-input events, plus one full tally to start from
+      _connection.Client().println("SUBSCRIBE ACTS");
+      _connection.Client().println("TALLY");
+    } else {
+      _connection.Client().println("SUBSCRIBE TALLY");
+    }
+  }
+  if (_connection.State() != CLIENT_SUBSCRIBED) {
+    return;
+  }
+  // only what is already in the W5100, in bursts rather than byte reads;
+  // a partial line stays in _lines for the next call
+  EthernetClient& client = _connection.Client();
+  int pending = client.available();
+  uint8_t chunk[32];
+  while (pending > 0) {
+    int n = client.read(chunk, pending < (int)sizeof(chunk)
+                                   ? pending
+                                   : (int)sizeof(chunk));
+    if (n <= 0) {
+      break;
+    }
+    pending -= n;
+    Receive(chunk, n);
+  }
+}
+
+void VmixSource::Teardown() {
+  _connection.Stop();
+  ClearCameras();
+}
+
+void VmixSource::Receive(const uint8_t* data, uint8_t length) {
+  for (uint8_t i = 0; i < length; i++) {
+    if (_lines.Push(data[i])) {
+      _connection.Answered();
+      HandleLine(_lines.Line(), _lines.Length());
+    }
+  }
+}
+
+/**
+ * @brief handle data from vMix
+ *  TALLY OK 0121...
+ *  one digit per input: 0 = off, 1 = program, 2 = preview
+ *  ACTS OK Input 3 1
+ *  one activator event, see HandleActs
+ *
+ * @param line one line of the vMix TCP API, without CR/LF
+ * @param length length of line
+ */
+void VmixSource::HandleLine(const char* line, uint8_t length) {
+  uint8_t count;
+  const char* states = VmixTallyStates(line, length, &count);
+  VmixActs event;
+  // Check if server data is Tally data
+  if (states) {
+    // a full resync. vMix folds the inputs in overlays into '1', so one that
+    // is only in an overlay looks like program here: HandleActs() asks
+    // again when it leaves the overlay. The overlays from ACTS are kept.
+    for (uint8_t camera = 0; camera < MAX_TALLY; camera++) {
+      char state = camera < count ? states[camera] : '0';
+      tally_mask_t bit = (tally_mask_t)1 << (camera % TALLY_MASK_BITS);
+      uint8_t w = camera / TALLY_MASK_BITS;
+      _input[w] = state == '1' ? (_input[w] | bit) : (_input[w] & ~bit);
+      _input_preview[w] = state == '2' ? (_input_preview[w] | bit)
+                                       : (_input_preview[w] & ~bit);
+      UpdateCamera(camera);
+    }
+  } else if (VmixActsEvent(line, length, &event)) {
+    HandleActs(event);
+  } else if (_acts && !_acts_refused &&
+             !strncmp_P(line, PSTR("SUBSCRIBE ER"), 12)) {
+    // a vMix without activator subscriptions, fall back to full tally, also
+    // after reconnects
+    Log.warning("Vmix refused ACTS, subscribing to TALLY" CR);
+    _acts_refused = true;
+    _connection.Client().println("SUBSCRIBE TALLY");
+  } else {
+    // tally and activator lines come several times a second, only the
+    // rest (subscription replies, errors) is logged
+    Log.notice("Response from vMix: %s" CR, line);
+  }
+}
+
+/**
+ * @brief apply one activator event to the one camera it concerns (two when
+ *  an overlay channel moves from one input to another)
+ */
+void VmixSource::HandleActs(const VmixActs& event) {
+  uint8_t camera = event.input - 1;
+  tally_mask_t bit = (tally_mask_t)1 << (camera % TALLY_MASK_BITS);
+  uint8_t w = camera / TALLY_MASK_BITS;
+  switch (event.activator) {
+    case VMIX_ACT_INPUT:
+      if (event.input > MAX_TALLY) {
+        return;
+      }
+      _input[w] = event.on ? (_input[w] | bit) : (_input[w] & ~bit);
+      break;
+    case VMIX_ACT_PREVIEW:
+      if (event.input > MAX_TALLY) {
+        return;
+      }
+      _input_preview[w] = event.on ? (_input_preview[w] | bit)
+                                   : (_input_preview[w] & ~bit);
+      break;
+    case VMIX_ACT_OVERLAY: {
+      uint16_t* overlay = &_overlay[event.overlay - 1];
+      // the input that leaves the overlay channel, if any
+      uint16_t leaving = event.on ? *overlay : event.input;
+      if (event.on) {
+        *overlay = event.input;
+      } else if (*overlay == event.input) {
+        *overlay = 0;
+      }
+      if (leaving && leaving != *overlay && leaving <= MAX_TALLY) {
+        uint8_t left = leaving - 1;
+        if ((_input[left / TALLY_MASK_BITS] >> (left % TALLY_MASK_BITS)) & 1) {
+          // on program since a TALLY line, maybe only through this overlay:
+          // only a new TALLY tells
+          _connection.Client().println("TALLY");
+        }
+        UpdateCamera(left);
+      }
+      if (event.input > MAX_TALLY) {
+        return;
+      }
+      break;
+    }
+    default:
+      return;
+  }
+  UpdateCamera(camera);
+}
+
+/**
+ * @brief camera tally from the vMix activators: program if its input is on
+ *  program or in an overlay channel that is on air
+ *
+ * @param camera 0-based camera index, camera n is vMix input n + 1
+ */
+void VmixSource::UpdateCamera(uint8_t camera) {
+  uint8_t w = camera / TALLY_MASK_BITS;
+  uint8_t bit = camera % TALLY_MASK_BITS;
+  bool program = (_input[w] >> bit) & 1;
+  for (uint8_t i = 0; i < VMIX_OVERLAYS; i++) {
+    program |= _overlay[i] == camera + 1;
+  }
+  SetCamera(0, camera, program, (_input_preview[w] >> bit) & 1);
+}
+
+#endif  // TALLY_VMIX
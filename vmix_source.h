@@ -0,0 +1,60 @@
+#ifndef VMIX_SOURCE_h
+#define VMIX_SOURCE_h
+
+#include "tally_source.h"
+
+#if TALLY_VMIX
+
+#include "vmix_protocol.h"
+
+// longest vMix line kept: "TALLY OK " plus one digit per camera, and at least
+// an "ACTS OK InputPreview 1000 1" event
+#ifndef VMIX_LINE_LENGTH
+#define VMIX_LINE_LENGTH \
+  (MAX_TALLY < 23 ? 32 : MAX_TALLY < 239 ? 9 + MAX_TALLY + 7 : 255)
+#endif
+// vMix overlay channels reported by ACTS
+#define VMIX_OVERLAYS 4
+
+/**
+ * @brief vMix over its TCP API (port 8099): SUBSCRIBE TALLY, or with
+ *  UseActs() per-input activator events, input n lights camera n
+ */
+class VmixSource : public TallySource {
+ private:
+  SourceClient _connection;
+  LineReader<VMIX_LINE_LENGTH> _lines;
+  bool _acts = false;
+  // the server answered SUBSCRIBE ER, ACTS is not asked again until Begin()
+  bool _acts_refused = false;
+  // vMix tally by activator: input on program / preview, input per overlay
+  tally_mask_t _input[TALLY_MASK_WORDS] = {0};
+  tally_mask_t _input_preview[TALLY_MASK_WORDS] = {0};
+  uint16_t _overlay[VMIX_OVERLAYS] = {0};
+
+  void HandleLine(const char* line, uint8_t length);
+  void HandleActs(const VmixActs& event);
+  void UpdateCamera(uint8_t camera);
+
+ public:
+  explicit VmixSource(IPAddress server, uint16_t port = 8099)
+      : _connection("Vmix", server, port) {}
+
+  // per-input activator events instead of the full tally string
+  void UseActs(bool acts) { _acts = acts; }
+  /**
+   * @brief bytes of the TCP stream, lines may straddle calls; Poll() feeds
+   *  what the W5100 holds, benchmarks feed their own
+   */
+  void Receive(const uint8_t* data, uint8_t length);
+
+  void Begin() override;
+  void Poll() override;
+  void Teardown() override;
+  SOURCE_HEALTH Health() override { return _connection.Health(); }
+  const char* Name() override { return "Vmix"; }
+};
+
+#endif  // TALLY_VMIX
+
+#endif